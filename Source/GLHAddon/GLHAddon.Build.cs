@@ -23,6 +23,8 @@ public class GLHAddon : ModuleRules
                 "Core",
                 "CoreUObject",
                 "Engine",
+                "AnimGraphRuntime",
+                "AnimationCore",
                 "ModularGameplay",
                 "GameplayTags",
                 "NetCore",
@@ -36,6 +38,8 @@ public class GLHAddon : ModuleRules
                 "GFCore",
                 "GCExt",
                 "GLExt",
+                "AnimationBudgetAllocator",
+                "AnimationSharing",
             }
         );
 
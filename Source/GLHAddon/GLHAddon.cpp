@@ -2,11 +2,14 @@
 
 #include "GLHAddon.h"
 
+#include "LocomotionHumanNameStatics.h"
+
 IMPLEMENT_MODULE(FGLHAddonModule, GLHAddon)
 
 
 void FGLHAddonModule::StartupModule()
 {
+	ULocomotionHumanNameStatics::InitializeNames();
 }
 
 void FGLHAddonModule::ShutdownModule()
@@ -0,0 +1,235 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimNode_HumanCycleLocomotion.h"
+
+#include "HumanAnimInstance.h"
+
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimSequence.h"
+#include "Animation/AnimTrace.h"
+#include "Animation/AnimationPoseData.h"
+#include "AnimationRuntime.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimNode_HumanCycleLocomotion)
+
+
+void FAnimNode_HumanCycleLocomotion::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread)
+
+	FAnimNode_Base::Initialize_AnyThread(Context);
+
+	HumanAnimInstance = UHumanAnimInstance::GetHumanAnimInstance(Context.AnimInstanceProxy);
+
+	NormalizedTime = 0.0f;
+	PreviousNormalizedTime = 0.0f;
+	RotationYawOffset = 0.0f;
+	Samples.Reset();
+}
+
+void FAnimNode_HumanCycleLocomotion::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Update_AnyThread)
+
+	GetEvaluateGraphExposedInputs().Execute(Context);
+
+	Samples.Reset();
+
+	if (!HumanAnimInstance)
+	{
+		return;
+	}
+
+	const auto& OnGroundState{ HumanAnimInstance->GetOnGroundState() };
+	const auto& PoseState{ HumanAnimInstance->GetPoseState() };
+	const auto& VelocityBlend{ OnGroundState.VelocityBlend };
+
+	// Normalize the velocity blend so that the directional weights always add up to one.
+
+	float DirectionWeights[4]{ VelocityBlend.ForwardAmount, VelocityBlend.BackwardAmount, VelocityBlend.LeftAmount, VelocityBlend.RightAmount };
+
+	const auto DirectionWeightsSum{ DirectionWeights[0] + DirectionWeights[1] + DirectionWeights[2] + DirectionWeights[3] };
+
+	if (DirectionWeightsSum > UE_SMALL_NUMBER)
+	{
+		for (auto& DirectionWeight : DirectionWeights)
+		{
+			DirectionWeight /= DirectionWeightsSum;
+		}
+	}
+	else
+	{
+		DirectionWeights[0] = 1.0f;
+	}
+
+	const auto StandingAmount{ 1.0f - PoseState.CrouchingAmount };
+	const auto RunningAmount{ PoseState.UnweightedGaitRunningAmount * (1.0f - PoseState.UnweightedGaitSprintingAmount) };
+	const auto SprintingAmount{ PoseState.UnweightedGaitRunningAmount * PoseState.UnweightedGaitSprintingAmount };
+	const auto WalkingAmount{ 1.0f - PoseState.UnweightedGaitRunningAmount };
+
+	GatherSamples(Walk, StandingAmount * WalkingAmount, OnGroundState.StandingPlayRate, DirectionWeights);
+	GatherSamples(Crouch, PoseState.CrouchingAmount, OnGroundState.CrouchingPlayRate, DirectionWeights);
+
+	if (SprintForward)
+	{
+		GatherSamples(Run, StandingAmount * RunningAmount, OnGroundState.StandingPlayRate, DirectionWeights);
+		AddSample(SprintForward, StandingAmount * SprintingAmount, OnGroundState.StandingPlayRate);
+	}
+	else
+	{
+		GatherSamples(Run, StandingAmount * (RunningAmount + SprintingAmount), OnGroundState.StandingPlayRate, DirectionWeights);
+	}
+
+	// All cycles share a single phase, which advances at the weighted average of their normalized play rates.
+
+	auto TotalWeight{ 0.0f };
+	auto NormalizedPlayRate{ 0.0f };
+
+	for (const auto& Sample : Samples)
+	{
+		TotalWeight += Sample.Weight;
+		NormalizedPlayRate += Sample.Weight * Sample.PlayRate / FMath::Max(Sample.Sequence->GetPlayLength(), UE_KINDA_SMALL_NUMBER);
+	}
+
+	if (TotalWeight > UE_SMALL_NUMBER)
+	{
+		for (auto& Sample : Samples)
+		{
+			Sample.Weight /= TotalWeight;
+		}
+
+		NormalizedPlayRate /= TotalWeight;
+	}
+
+	PreviousNormalizedTime = NormalizedTime;
+	NormalizedTime = FMath::Frac(NormalizedTime + Context.GetDeltaTime() * NormalizedPlayRate);
+
+	const auto& YawOffsets{ OnGroundState.RotationYawOffsets };
+
+	RotationYawOffset = bApplyRotationYawOffsets
+		? YawOffsets.ForwardAngle * DirectionWeights[0] + YawOffsets.BackwardAngle * DirectionWeights[1] +
+		  YawOffsets.LeftAngle * DirectionWeights[2] + YawOffsets.RightAngle * DirectionWeights[3]
+		: 0.0f;
+
+	TRACE_ANIM_NODE_VALUE(Context, TEXT("Samples"), Samples.Num());
+	TRACE_ANIM_NODE_VALUE(Context, TEXT("Normalized Time"), NormalizedTime);
+	TRACE_ANIM_NODE_VALUE(Context, TEXT("Rotation Yaw Offset"), RotationYawOffset);
+}
+
+void FAnimNode_HumanCycleLocomotion::Evaluate_AnyThread(FPoseContext& Output)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Evaluate_AnyThread)
+
+	const auto NumSamples{ Samples.Num() };
+
+	if (NumSamples <= 0)
+	{
+		Output.ResetToRefPose();
+		return;
+	}
+
+	static const auto ExtractPose
+	{
+		[](const FHumanCycleSample& Sample, float NormalizedTime, float PreviousNormalizedTime, FAnimationPoseData& OutPoseData)
+		{
+			const auto PlayLength{ Sample.Sequence->GetPlayLength() };
+			const auto Time{ NormalizedTime * PlayLength };
+
+			// Phase always moves forward, so a smaller value means it has wrapped around.
+
+			FDeltaTimeRecord DeltaTimeRecord;
+			DeltaTimeRecord.Set(PreviousNormalizedTime * PlayLength, FMath::Frac(NormalizedTime - PreviousNormalizedTime + 1.0f) * PlayLength);
+
+			Sample.Sequence->GetAnimationPose(OutPoseData, FAnimExtractContext(static_cast<double>(Time), false, DeltaTimeRecord, true));
+		}
+	};
+
+	if (NumSamples == 1)
+	{
+		FAnimationPoseData OutputPoseData{ Output };
+		ExtractPose(Samples[0], NormalizedTime, PreviousNormalizedTime, OutputPoseData);
+	}
+	else
+	{
+		TArray<FCompactPose, TInlineAllocator<8>> Poses;
+		TArray<FBlendedCurve, TInlineAllocator<8>> Curves;
+		TArray<UE::Anim::FStackAttributeContainer, TInlineAllocator<8>> Attributes;
+		TArray<float, TInlineAllocator<8>> Weights;
+
+		Poses.SetNum(NumSamples);
+		Curves.SetNum(NumSamples);
+		Attributes.SetNum(NumSamples);
+		Weights.SetNum(NumSamples);
+
+		for (auto i{ 0 }; i < NumSamples; i++)
+		{
+			Poses[i].SetBoneContainer(&Output.Pose.GetBoneContainer());
+			Curves[i].InitFrom(Output.Curve);
+			Weights[i] = Samples[i].Weight;
+
+			FAnimationPoseData SamplePoseData{ Poses[i], Curves[i], Attributes[i] };
+			ExtractPose(Samples[i], NormalizedTime, PreviousNormalizedTime, SamplePoseData);
+		}
+
+		FAnimationPoseData OutputPoseData{ Output };
+		FAnimationRuntime::BlendPosesTogether(Poses, Curves, Attributes, Weights, OutputPoseData);
+	}
+
+	if (!FMath::IsNearlyZero(RotationYawOffset))
+	{
+		auto& RootTransform{ Output.Pose[FCompactPoseBoneIndex(0)] };
+
+		RootTransform.SetRotation(FQuat(FVector::UpVector, FMath::DegreesToRadians(RotationYawOffset)) * RootTransform.GetRotation());
+	}
+}
+
+void FAnimNode_HumanCycleLocomotion::GatherDebugData(FNodeDebugData& DebugData)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(GatherDebugData)
+
+	auto DebugLine{ DebugData.GetNodeName(this) };
+	DebugLine += FString::Printf(TEXT("(Samples: %d, Normalized Time: %.2f)"), Samples.Num(), NormalizedTime);
+
+	for (const auto& Sample : Samples)
+	{
+		DebugLine += FString::Printf(TEXT(" %s: %.2f"), *GetNameSafe(Sample.Sequence), Sample.Weight);
+	}
+
+	DebugData.AddDebugItem(DebugLine, true);
+}
+
+
+void FAnimNode_HumanCycleLocomotion::GatherSamples(const FHumanDirectionalCycles& Cycles, float GaitWeight, float PlayRate, const float (&DirectionWeights)[4])
+{
+	if (!FAnimWeight::IsRelevant(GaitWeight))
+	{
+		return;
+	}
+
+	AddSample(Cycles.Forward, GaitWeight * DirectionWeights[0], PlayRate);
+	AddSample(Cycles.Backward, GaitWeight * DirectionWeights[1], PlayRate);
+	AddSample(Cycles.Left, GaitWeight * DirectionWeights[2], PlayRate);
+	AddSample(Cycles.Right, GaitWeight * DirectionWeights[3], PlayRate);
+}
+
+void FAnimNode_HumanCycleLocomotion::AddSample(const UAnimSequence* Sequence, float Weight, float PlayRate)
+{
+	if (!Sequence || !FAnimWeight::IsRelevant(Weight))
+	{
+		return;
+	}
+
+	// The same cycle may be used for several gaits, so merge them into a single sample.
+
+	for (auto& Sample : Samples)
+	{
+		if (Sample.Sequence == Sequence)
+		{
+			Sample.PlayRate = (Sample.PlayRate * Sample.Weight + PlayRate * Weight) / (Sample.Weight + Weight);
+			Sample.Weight += Weight;
+			return;
+		}
+	}
+
+	Samples.Add({ Sequence, Weight, PlayRate });
+}
@@ -0,0 +1,113 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Animation/AnimNodeBase.h"
+
+#include "AnimNode_HumanCycleLocomotion.generated.h"
+
+class UHumanAnimInstance;
+class UAnimSequence;
+
+
+/**
+ * Cycle animations of each movement direction for a single gait or stance
+ */
+USTRUCT(BlueprintType)
+struct GLHADDON_API FHumanDirectionalCycles
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TObjectPtr<UAnimSequence> Forward{ nullptr };
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TObjectPtr<UAnimSequence> Backward{ nullptr };
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TObjectPtr<UAnimSequence> Left{ nullptr };
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TObjectPtr<UAnimSequence> Right{ nullptr };
+
+};
+
+
+/**
+ * Cycle to be sampled in the current frame and its weight
+ */
+struct FHumanCycleSample
+{
+public:
+	const UAnimSequence* Sequence{ nullptr };
+
+	float Weight{ 0.0f };
+
+	float PlayRate{ 1.0f };
+
+};
+
+
+/**
+ * Anim node that blends directional locomotion cycles using the on ground state of the human character
+ *
+ * Tips:
+ *	All cycles share a single normalized phase, so they must start on the same foot.
+ *	Cycles whose weight is not relevant are not sampled at all.
+ *	Anim notifies of the cycles are not triggered by this node.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct GLHADDON_API FAnimNode_HumanCycleLocomotion : public FAnimNode_Base
+{
+	GENERATED_BODY()
+
+public:
+	FAnimNode_HumanCycleLocomotion() {}
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Cycles")
+	FHumanDirectionalCycles Walk;
+
+	UPROPERTY(EditAnywhere, Category = "Cycles")
+	FHumanDirectionalCycles Run;
+
+	//
+	// Only the forward cycle is used since sprinting is always forward.
+	// Falls back to the run cycles if not set.
+	//
+	UPROPERTY(EditAnywhere, Category = "Cycles")
+	TObjectPtr<UAnimSequence> SprintForward{ nullptr };
+
+	UPROPERTY(EditAnywhere, Category = "Cycles")
+	FHumanDirectionalCycles Crouch;
+
+	//
+	// Whether to rotate the root bone by the RotationYawOffsets of the on ground state
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bApplyRotationYawOffsets{ true };
+
+protected:
+	const UHumanAnimInstance* HumanAnimInstance{ nullptr };
+
+	TArray<FHumanCycleSample, TInlineAllocator<8>> Samples;
+
+	float NormalizedTime{ 0.0f };
+
+	float PreviousNormalizedTime{ 0.0f };
+
+	float RotationYawOffset{ 0.0f };
+
+public:
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+
+protected:
+	void GatherSamples(const FHumanDirectionalCycles& Cycles, float GaitWeight, float PlayRate, const float (&DirectionWeights)[4]);
+
+	void AddSample(const UAnimSequence* Sequence, float Weight, float PlayRate);
+
+};
@@ -0,0 +1,135 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimNode_HumanFootIk.h"
+
+#include "HumanAnimInstance.h"
+#include "LocomotionHumanNameStatics.h"
+
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimTrace.h"
+#include "TwoBoneIK.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimNode_HumanFootIk)
+
+
+FAnimNode_HumanFootIk::FAnimNode_HumanFootIk()
+{
+	PelvisBone.BoneName = ULocomotionHumanNameStatics::PelvisBoneName();
+	FootLeftBone.BoneName = ULocomotionHumanNameStatics::FootLeftBoneName();
+	FootRightBone.BoneName = ULocomotionHumanNameStatics::FootRightBoneName();
+}
+
+
+void FAnimNode_HumanFootIk::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread)
+
+	FAnimNode_SkeletalControlBase::Initialize_AnyThread(Context);
+
+	HumanAnimInstance = UHumanAnimInstance::GetHumanAnimInstance(Context.AnimInstanceProxy);
+}
+
+void FAnimNode_HumanFootIk::GatherDebugData(FNodeDebugData& DebugData)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(GatherDebugData)
+
+	auto DebugLine{ DebugData.GetNodeName(this) };
+	DebugLine += FString::Printf(TEXT("(Alpha: %.1f%%)"), ActualAlpha * 100.0f);
+
+	DebugData.AddDebugItem(DebugLine);
+
+	ComponentPose.GatherDebugData(DebugData);
+}
+
+void FAnimNode_HumanFootIk::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(EvaluateSkeletalControl_AnyThread)
+
+	if (!HumanAnimInstance)
+	{
+		return;
+	}
+
+	const auto& FeetState{ HumanAnimInstance->GetFeetState() };
+	const auto& BoneContainer{ Output.Pose.GetPose().GetBoneContainer() };
+
+	// Lower the pelvis by the lowest foot offset so that both feet can reach their IK locations.
+
+	const FVector PelvisOffset{ 0.0f, 0.0f, bApplyPelvisOffset ? FeetState.MinMaxPelvisOffsetZ.X : 0.0f };
+
+	if (!PelvisOffset.IsNearlyZero())
+	{
+		const auto PelvisIndex{ PelvisBone.GetCompactPoseIndex(BoneContainer) };
+
+		auto PelvisTransform{ Output.Pose.GetComponentSpaceTransform(PelvisIndex) };
+		PelvisTransform.AddToTranslation(PelvisOffset);
+
+		OutBoneTransforms.Add(FBoneTransform(PelvisIndex, PelvisTransform));
+	}
+
+	SolveLeg(Output, FootLeftBone, FeetState.Left, PelvisOffset, OutBoneTransforms);
+	SolveLeg(Output, FootRightBone, FeetState.Right, PelvisOffset, OutBoneTransforms);
+
+	OutBoneTransforms.Sort(FCompareBoneTransformIndex());
+
+	TRACE_ANIM_NODE_VALUE(Output, TEXT("Pelvis Offset Z"), PelvisOffset.Z);
+	TRACE_ANIM_NODE_VALUE(Output, TEXT("Foot Left Ik Amount"), FeetState.Left.IkAmount);
+	TRACE_ANIM_NODE_VALUE(Output, TEXT("Foot Right Ik Amount"), FeetState.Right.IkAmount);
+}
+
+bool FAnimNode_HumanFootIk::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
+{
+	return PelvisBone.IsValidToEvaluate(RequiredBones) && FootLeftBone.IsValidToEvaluate(RequiredBones) && FootRightBone.IsValidToEvaluate(RequiredBones);
+}
+
+void FAnimNode_HumanFootIk::InitializeBoneReferences(const FBoneContainer& RequiredBones)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(InitializeBoneReferences)
+
+	PelvisBone.Initialize(RequiredBones);
+	FootLeftBone.Initialize(RequiredBones);
+	FootRightBone.Initialize(RequiredBones);
+}
+
+void FAnimNode_HumanFootIk::SolveLeg(FComponentSpacePoseContext& Output, const FBoneReference& FootBone, const FFootState& FootState, const FVector& PelvisOffset, TArray<FBoneTransform>& OutBoneTransforms) const
+{
+	if (!FAnimWeight::IsRelevant(FootState.IkAmount) && PelvisOffset.IsNearlyZero())
+	{
+		return;
+	}
+
+	const auto& BoneContainer{ Output.Pose.GetPose().GetBoneContainer() };
+
+	const auto FootIndex{ FootBone.GetCompactPoseIndex(BoneContainer) };
+	const auto KneeIndex{ BoneContainer.GetParentBoneIndex(FootIndex) };
+	const auto ThighIndex{ KneeIndex.IsValid() ? BoneContainer.GetParentBoneIndex(KneeIndex) : FCompactPoseBoneIndex(INDEX_NONE) };
+
+	if (!ThighIndex.IsValid())
+	{
+		return;
+	}
+
+	// The pelvis offset has not yet been applied to the pose, so it is added to the leg manually.
+
+	auto ThighTransform{ Output.Pose.GetComponentSpaceTransform(ThighIndex) };
+	auto KneeTransform{ Output.Pose.GetComponentSpaceTransform(KneeIndex) };
+	auto FootTransform{ Output.Pose.GetComponentSpaceTransform(FootIndex) };
+
+	ThighTransform.AddToTranslation(PelvisOffset);
+	KneeTransform.AddToTranslation(PelvisOffset);
+	FootTransform.AddToTranslation(PelvisOffset);
+
+	const auto FootRotation{ FootTransform.GetRotation() };
+	const auto EffectorLocation{ FMath::Lerp(FootTransform.GetLocation(), FootState.IkLocation, FootState.IkAmount) };
+
+	// Using the current knee location as the joint target keeps the bending plane of the leg.
+
+	AnimationCore::SolveTwoBoneIK(ThighTransform, KneeTransform, FootTransform, KneeTransform.GetLocation(), EffectorLocation,
+		bAllowStretching, StartStretchRatio, MaxStretchScale);
+
+	FootTransform.SetRotation(bApplyFootRotation ? FQuat::Slerp(FootRotation, FootState.IkRotation, FootState.IkAmount) : FootRotation);
+
+	OutBoneTransforms.Add(FBoneTransform(ThighIndex, ThighTransform));
+	OutBoneTransforms.Add(FBoneTransform(KneeIndex, KneeTransform));
+	OutBoneTransforms.Add(FBoneTransform(FootIndex, FootTransform));
+}
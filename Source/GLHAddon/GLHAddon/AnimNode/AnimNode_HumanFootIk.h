@@ -0,0 +1,70 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "BoneControllers/AnimNode_SkeletalControlBase.h"
+
+#include "AnimNode_HumanFootIk.generated.h"
+
+class UHumanAnimInstance;
+struct FFootState;
+
+
+/**
+ * Anim node that applies the foot IK and pelvis offset of FFeetState without using Control Rig
+ *
+ * Tips:
+ *	The state is read by reference from the owning UHumanAnimInstance.
+ *	The knee and thigh of each leg are the parent and grandparent of the foot bone.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct GLHADDON_API FAnimNode_HumanFootIk : public FAnimNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+public:
+	FAnimNode_HumanFootIk();
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference PelvisBone;
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference FootLeftBone;
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference FootRightBone;
+
+	//
+	// Whether to move the pelvis down so that the lowest foot can reach its IK location
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bApplyPelvisOffset{ true };
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bApplyFootRotation{ true };
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bAllowStretching{ false };
+
+	UPROPERTY(EditAnywhere, Category = "Settings", Meta = (ClampMin = 0, EditCondition = "bAllowStretching"))
+	float StartStretchRatio{ 1.0f };
+
+	UPROPERTY(EditAnywhere, Category = "Settings", Meta = (ClampMin = 0, EditCondition = "bAllowStretching"))
+	float MaxStretchScale{ 1.2f };
+
+protected:
+	const UHumanAnimInstance* HumanAnimInstance{ nullptr };
+
+public:
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+	virtual void EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms) override;
+	virtual bool IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) override;
+
+protected:
+	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
+
+	void SolveLeg(FComponentSpacePoseContext& Output, const FBoneReference& FootBone, const FFootState& FootState, const FVector& PelvisOffset, TArray<FBoneTransform>& OutBoneTransforms) const;
+
+};
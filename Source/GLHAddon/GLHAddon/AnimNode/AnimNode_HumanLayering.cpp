@@ -0,0 +1,309 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimNode_HumanLayering.h"
+
+#include "HumanAnimInstance.h"
+#include "HumanSkeletonCacheRegistry.h"
+
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimTrace.h"
+#include "Animation/AnimationPoseData.h"
+#include "AnimationRuntime.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimNode_HumanLayering)
+
+
+FAnimNode_HumanLayering::FAnimNode_HumanLayering()
+{
+	RegionRootBones =
+	{
+		{ TEXT("pelvis"),		EHumanLayeringRegion::Pelvis },
+		{ TEXT("thigh_l"),		EHumanLayeringRegion::Legs },
+		{ TEXT("thigh_r"),		EHumanLayeringRegion::Legs },
+		{ TEXT("spine_01"),		EHumanLayeringRegion::Spine },
+		{ TEXT("neck_01"),		EHumanLayeringRegion::Head },
+		{ TEXT("clavicle_l"),	EHumanLayeringRegion::ArmLeft },
+		{ TEXT("clavicle_r"),	EHumanLayeringRegion::ArmRight },
+		{ TEXT("hand_l"),		EHumanLayeringRegion::HandLeft },
+		{ TEXT("hand_r"),		EHumanLayeringRegion::HandRight },
+	};
+}
+
+
+void FAnimNode_HumanLayering::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread)
+
+	FAnimNode_Base::Initialize_AnyThread(Context);
+
+	BasePose.Initialize(Context);
+	OverlayPose.Initialize(Context);
+	BaseAdditivePose.Initialize(Context);
+	BaseMeshSpaceAdditivePose.Initialize(Context);
+	SlotPose.Initialize(Context);
+
+	HumanAnimInstance = UHumanAnimInstance::GetHumanAnimInstance(Context.AnimInstanceProxy);
+}
+
+void FAnimNode_HumanLayering::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(CacheBones_AnyThread)
+
+	BasePose.CacheBones(Context);
+	OverlayPose.CacheBones(Context);
+	BaseAdditivePose.CacheBones(Context);
+	BaseMeshSpaceAdditivePose.CacheBones(Context);
+	SlotPose.CacheBones(Context);
+
+	const auto* Skeleton{ Context.AnimInstanceProxy->GetSkeleton() };
+
+	if (!RegionTable.IsValid() || !RegionTable->IsValidFor(Skeleton))
+	{
+		RegionTable = FHumanSkeletonCacheRegistry::Get().FindOrAddLayeringRegionTable(Skeleton, RegionRootBones);
+	}
+
+	static const TArray<EHumanLayeringRegion> EmptyRegions;
+
+	const auto& SkeletonBoneRegions{ RegionTable.IsValid() ? RegionTable->SkeletonBoneRegions : EmptyRegions };
+
+	// Remap the skeleton table to the bones required by the current LOD
+
+	const auto& RequiredBones{ Context.AnimInstanceProxy->GetRequiredBones() };
+	const auto NumBones{ RequiredBones.GetCompactPoseNumBones() };
+
+	CompactPoseBoneRegions.Reset(NumBones);
+
+	for (auto i{ 0 }; i < NumBones; i++)
+	{
+		const auto SkeletonBoneIndex{ RequiredBones.GetSkeletonIndex(FCompactPoseBoneIndex(i)) };
+
+		CompactPoseBoneRegions.Add(SkeletonBoneRegions.IsValidIndex(SkeletonBoneIndex) ? SkeletonBoneRegions[SkeletonBoneIndex] : EHumanLayeringRegion::None);
+	}
+}
+
+void FAnimNode_HumanLayering::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Update_AnyThread)
+
+	GetEvaluateGraphExposedInputs().Execute(Context);
+
+	const auto& State{ (bUseAnimInstanceLayeringState && HumanAnimInstance) ? HumanAnimInstance->GetLayeringState() : LayeringState };
+
+	UpdateRegionWeights(State, Context.AnimInstanceProxy->GetSlotNodeGlobalWeight(SlotName));
+
+	// Only update the poses that contribute to the result
+
+	BasePose.Update(Context);
+
+	if (bOverlayRelevant)
+	{
+		OverlayPose.Update(Context);
+	}
+
+	if (bLocalSpaceAdditiveRelevant)
+	{
+		BaseAdditivePose.Update(Context);
+	}
+
+	if (bMeshSpaceAdditiveRelevant)
+	{
+		BaseMeshSpaceAdditivePose.Update(Context);
+	}
+
+	if (bSlotRelevant)
+	{
+		SlotPose.Update(Context);
+	}
+
+	TRACE_ANIM_NODE_VALUE(Context, TEXT("Overlay Relevant"), bOverlayRelevant);
+	TRACE_ANIM_NODE_VALUE(Context, TEXT("Slot Relevant"), bSlotRelevant);
+}
+
+void FAnimNode_HumanLayering::Evaluate_AnyThread(FPoseContext& Output)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Evaluate_AnyThread)
+
+	if (!bOverlayRelevant && !bSlotRelevant)
+	{
+		BasePose.Evaluate(Output);
+		return;
+	}
+
+	FPoseContext BaseContext{ Output };
+	BasePose.Evaluate(BaseContext);
+
+	// Build the layered pose from the overlay and the additive motion of the base layer
+
+	FPoseContext LayeredContext{ Output };
+
+	if (bOverlayRelevant)
+	{
+		OverlayPose.Evaluate(LayeredContext);
+
+		if (bLocalSpaceAdditiveRelevant)
+		{
+			FPoseContext AdditiveContext{ Output, true };
+			BaseAdditivePose.Evaluate(AdditiveContext);
+
+			for (const auto BoneIndex : LayeredContext.Pose.ForEachBoneIndex())
+			{
+				const auto Weight{ GetRegionWeights(CompactPoseBoneRegions[BoneIndex.GetInt()]).LocalSpaceAdditiveAmount };
+
+				if (FAnimWeight::IsRelevant(Weight))
+				{
+					FTransform::BlendFromIdentityAndAccumulate(LayeredContext.Pose[BoneIndex], AdditiveContext.Pose[BoneIndex], ScalarRegister(Weight));
+				}
+			}
+
+			LayeredContext.Pose.NormalizeRotations();
+		}
+
+		if (bMeshSpaceAdditiveRelevant)
+		{
+			FPoseContext AdditiveContext{ Output, true };
+			BaseMeshSpaceAdditivePose.Evaluate(AdditiveContext);
+
+			// Mesh space additive can only be applied to the whole pose, so apply it to a copy and blend it per bone.
+
+			FPoseContext MeshSpaceContext{ LayeredContext };
+			MeshSpaceContext.Pose.CopyBonesFrom(LayeredContext.Pose);
+			MeshSpaceContext.Curve.CopyFrom(LayeredContext.Curve);
+
+			FAnimationPoseData MeshSpacePoseData{ MeshSpaceContext };
+			FAnimationRuntime::AccumulateMeshSpaceRotationAdditiveToLocalPose(MeshSpacePoseData, FAnimationPoseData{ AdditiveContext }, 1.0f);
+
+			for (const auto BoneIndex : LayeredContext.Pose.ForEachBoneIndex())
+			{
+				const auto Weight{ GetRegionWeights(CompactPoseBoneRegions[BoneIndex.GetInt()]).MeshSpaceAdditiveAmount };
+
+				if (FAnimWeight::IsRelevant(Weight))
+				{
+					LayeredContext.Pose[BoneIndex].BlendWith(MeshSpaceContext.Pose[BoneIndex], Weight);
+				}
+			}
+		}
+	}
+
+	FPoseContext SlotContext{ Output };
+
+	if (bSlotRelevant)
+	{
+		SlotPose.Evaluate(SlotContext);
+	}
+
+	// Blend all the poses per bone according to the region weights
+
+	Output.Pose.CopyBonesFrom(BaseContext.Pose);
+
+	for (const auto BoneIndex : Output.Pose.ForEachBoneIndex())
+	{
+		const auto& Weights{ GetRegionWeights(CompactPoseBoneRegions[BoneIndex.GetInt()]) };
+
+		auto& Transform{ Output.Pose[BoneIndex] };
+
+		if (bOverlayRelevant && FAnimWeight::IsRelevant(Weights.OverlayAmount))
+		{
+			Transform.BlendWith(LayeredContext.Pose[BoneIndex], Weights.OverlayAmount);
+		}
+
+		if (bSlotRelevant && FAnimWeight::IsRelevant(Weights.SlotAmount))
+		{
+			Transform.BlendWith(SlotContext.Pose[BoneIndex], Weights.SlotAmount);
+		}
+	}
+
+	Output.Pose.NormalizeRotations();
+
+	// Layering curves are authored in the overlay animations, so they take precedence over the base curves.
+
+	Output.Curve.CopyFrom(BaseContext.Curve);
+
+	if (bOverlayRelevant)
+	{
+		Output.Curve.Combine(LayeredContext.Curve);
+	}
+
+	if (bSlotRelevant)
+	{
+		Output.Curve.Combine(SlotContext.Curve);
+	}
+
+	Output.CustomAttributes.CopyFrom(BaseContext.CustomAttributes);
+}
+
+void FAnimNode_HumanLayering::GatherDebugData(FNodeDebugData& DebugData)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(GatherDebugData)
+
+	auto DebugLine{ DebugData.GetNodeName(this) };
+	DebugLine += FString::Printf(TEXT("(Overlay: %d, LocalAdditive: %d, MeshAdditive: %d, Slot: %d)"),
+		bOverlayRelevant, bLocalSpaceAdditiveRelevant, bMeshSpaceAdditiveRelevant, bSlotRelevant);
+
+	DebugData.AddDebugItem(DebugLine);
+
+	BasePose.GatherDebugData(DebugData.BranchFlow(1.0f));
+	OverlayPose.GatherDebugData(DebugData.BranchFlow(bOverlayRelevant ? 1.0f : 0.0f));
+	BaseAdditivePose.GatherDebugData(DebugData.BranchFlow(bLocalSpaceAdditiveRelevant ? 1.0f : 0.0f));
+	BaseMeshSpaceAdditivePose.GatherDebugData(DebugData.BranchFlow(bMeshSpaceAdditiveRelevant ? 1.0f : 0.0f));
+	SlotPose.GatherDebugData(DebugData.BranchFlow(bSlotRelevant ? 1.0f : 0.0f));
+}
+
+
+void FAnimNode_HumanLayering::UpdateRegionWeights(const FLayeringState& State, float SlotWeight)
+{
+	static const auto SetRegionWeights
+	{
+		[](FHumanLayeringRegionWeights& Weights, float OverlayAmount, float AdditiveAmount, float LocalSpaceAmount, float SlotAmount)
+		{
+			Weights.OverlayAmount = OverlayAmount;
+			Weights.LocalSpaceAdditiveAmount = AdditiveAmount * LocalSpaceAmount;
+			Weights.MeshSpaceAdditiveAmount = AdditiveAmount * (1.0f - LocalSpaceAmount);
+			Weights.SlotAmount = SlotAmount;
+		}
+	};
+
+	auto& Weights{ RegionWeights };
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::None)], 0.0f, 0.0f, 1.0f, 0.0f);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::Pelvis)],
+		State.PelvisBlendAmount, 0.0f, 1.0f, State.PelvisSlotBlendAmount * SlotWeight);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::Legs)],
+		State.LegsBlendAmount, 0.0f, 1.0f, State.LegsSlotBlendAmount * SlotWeight);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::Spine)],
+		State.SpineBlendAmount, State.SpineAdditiveBlendAmount, 0.0f, State.SpineSlotBlendAmount * SlotWeight);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::Head)],
+		State.HeadBlendAmount, State.HeadAdditiveBlendAmount, 1.0f, State.HeadSlotBlendAmount * SlotWeight);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::ArmLeft)],
+		State.ArmLeftBlendAmount, State.ArmLeftAdditiveBlendAmount, State.ArmLeftLocalSpaceBlendAmount, State.ArmLeftSlotBlendAmount * SlotWeight);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::ArmRight)],
+		State.ArmRightBlendAmount, State.ArmRightAdditiveBlendAmount, State.ArmRightLocalSpaceBlendAmount, State.ArmRightSlotBlendAmount * SlotWeight);
+
+	// Hands follow the additive and slot settings of their arms, but have their own overlay amount.
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::HandLeft)],
+		State.HandLeftBlendAmount, State.ArmLeftAdditiveBlendAmount, State.ArmLeftLocalSpaceBlendAmount, State.ArmLeftSlotBlendAmount * SlotWeight);
+
+	SetRegionWeights(Weights[static_cast<uint8>(EHumanLayeringRegion::HandRight)],
+		State.HandRightBlendAmount, State.ArmRightAdditiveBlendAmount, State.ArmRightLocalSpaceBlendAmount, State.ArmRightSlotBlendAmount * SlotWeight);
+
+	bOverlayRelevant = false;
+	bLocalSpaceAdditiveRelevant = false;
+	bMeshSpaceAdditiveRelevant = false;
+	bSlotRelevant = false;
+
+	for (const auto& RegionWeight : Weights)
+	{
+		const auto bRegionOverlayRelevant{ FAnimWeight::IsRelevant(RegionWeight.OverlayAmount) };
+
+		bOverlayRelevant |= bRegionOverlayRelevant;
+		bLocalSpaceAdditiveRelevant |= bRegionOverlayRelevant && FAnimWeight::IsRelevant(RegionWeight.LocalSpaceAdditiveAmount);
+		bMeshSpaceAdditiveRelevant |= bRegionOverlayRelevant && FAnimWeight::IsRelevant(RegionWeight.MeshSpaceAdditiveAmount);
+		bSlotRelevant |= FAnimWeight::IsRelevant(RegionWeight.SlotAmount);
+	}
+}
@@ -0,0 +1,161 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Animation/AnimNodeBase.h"
+
+#include "State/LayeringState.h"
+
+#include "AnimNode_HumanLayering.generated.h"
+
+class UHumanAnimInstance;
+struct FHumanLayeringRegionTable;
+
+
+/**
+ * Body regions to which each layering amount of FLayeringState is applied
+ */
+UENUM(BlueprintType)
+enum class EHumanLayeringRegion : uint8
+{
+	None,
+	Pelvis,
+	Legs,
+	Spine,
+	Head,
+	ArmLeft,
+	ArmRight,
+	HandLeft,
+	HandRight,
+
+	MAX		UMETA(Hidden)
+};
+
+
+/**
+ * Blend weights of a single region resolved from FLayeringState
+ */
+struct FHumanLayeringRegionWeights
+{
+public:
+	float OverlayAmount{ 0.0f };
+
+	float LocalSpaceAdditiveAmount{ 0.0f };
+
+	float MeshSpaceAdditiveAmount{ 0.0f };
+
+	float SlotAmount{ 0.0f };
+
+};
+
+
+/**
+ * Anim node that applies all FLayeringState amounts of the human character in a single pass
+ *
+ * Tips:
+ *	Replaces the Layered Blend Per Bone, additive and slot nodes that were used for each body region.
+ *	Region of each bone is resolved from the skeleton once and cached as a table for the required bones.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct GLHADDON_API FAnimNode_HumanLayering : public FAnimNode_Base
+{
+	GENERATED_BODY()
+
+public:
+	FAnimNode_HumanLayering();
+
+public:
+	//
+	// Pose of the base layer (Locomotion without overlay)
+	//
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink BasePose;
+
+	//
+	// Pose of the overlay layer
+	//
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink OverlayPose;
+
+	//
+	// Local space additive pose of the base layer that is added on top of the overlay
+	//
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink BaseAdditivePose;
+
+	//
+	// Mesh space rotation additive pose of the base layer that is added on top of the overlay
+	//
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink BaseMeshSpaceAdditivePose;
+
+	//
+	// Pose with the montage of SlotName applied
+	//
+	// Tips:
+	//	It is evaluated only while the slot has weight
+	//
+	UPROPERTY(EditAnywhere, Category = "Links")
+	FPoseLink SlotPose;
+
+	//
+	// Layering state used when bUseAnimInstanceLayeringState is false or the AnimInstance is not human
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings", Meta = (PinShownByDefault))
+	FLayeringState LayeringState;
+
+	//
+	// Whether to read the LayeringState of the owning UHumanAnimInstance directly instead of the pin
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bUseAnimInstanceLayeringState{ true };
+
+	//
+	// Name of the slot used to determine the weight of the SlotPose
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FName SlotName{ TEXT("DefaultSlot") };
+
+	//
+	// Bones from which each region begins.
+	// Child bones belong to the region of their nearest listed ancestor.
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TMap<FName, EHumanLayeringRegion> RegionRootBones;
+
+protected:
+	const UHumanAnimInstance* HumanAnimInstance{ nullptr };
+
+	FHumanLayeringRegionWeights RegionWeights[static_cast<uint8>(EHumanLayeringRegion::MAX)];
+
+	//
+	// Region of each bone indexed by skeleton bone index, shared by all nodes with the same skeleton and RegionRootBones
+	//
+	TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe> RegionTable;
+
+	//
+	// Region of each bone indexed by compact pose bone index
+	//
+	TArray<EHumanLayeringRegion> CompactPoseBoneRegions;
+
+	bool bOverlayRelevant{ false };
+	bool bLocalSpaceAdditiveRelevant{ false };
+	bool bMeshSpaceAdditiveRelevant{ false };
+	bool bSlotRelevant{ false };
+
+public:
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+
+protected:
+	void UpdateRegionWeights(const FLayeringState& State, float SlotWeight);
+
+	const FHumanLayeringRegionWeights& GetRegionWeights(EHumanLayeringRegion Region) const
+	{
+		return RegionWeights[static_cast<uint8>(Region)];
+	}
+
+};
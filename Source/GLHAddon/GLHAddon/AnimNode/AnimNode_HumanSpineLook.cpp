@@ -0,0 +1,163 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimNode_HumanSpineLook.h"
+
+#include "HumanAnimInstance.h"
+#include "LocomotionHumanNameStatics.h"
+
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimTrace.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimNode_HumanSpineLook)
+
+
+FAnimNode_HumanSpineLook::FAnimNode_HumanSpineLook()
+{
+	SpineBones =
+	{
+		{ ULocomotionHumanNameStatics::Spine01BoneName(), 1.0f },
+		{ ULocomotionHumanNameStatics::Spine02BoneName(), 1.0f },
+		{ ULocomotionHumanNameStatics::Spine03BoneName(), 1.0f },
+	};
+
+	LookBones =
+	{
+		{ ULocomotionHumanNameStatics::Neck01BoneName(), 1.0f },
+		{ ULocomotionHumanNameStatics::HeadBoneName(), 1.0f },
+	};
+}
+
+
+void FAnimNode_HumanSpineLook::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread)
+
+	FAnimNode_SkeletalControlBase::Initialize_AnyThread(Context);
+
+	HumanAnimInstance = UHumanAnimInstance::GetHumanAnimInstance(Context.AnimInstanceProxy);
+}
+
+void FAnimNode_HumanSpineLook::GatherDebugData(FNodeDebugData& DebugData)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(GatherDebugData)
+
+	auto DebugLine{ DebugData.GetNodeName(this) };
+	DebugLine += FString::Printf(TEXT("(Alpha: %.1f%%)"), ActualAlpha * 100.0f);
+
+	DebugData.AddDebugItem(DebugLine);
+
+	ComponentPose.GatherDebugData(DebugData);
+}
+
+void FAnimNode_HumanSpineLook::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(EvaluateSkeletalControl_AnyThread)
+
+	if (!HumanAnimInstance)
+	{
+		return;
+	}
+
+	const auto SpineYawAngle{ bApplySpineRotation ? HumanAnimInstance->GetSpineRotationState().YawAngle : 0.0f };
+
+	// Rigid motion that has been applied to the chain so far. Child bones inherit it before adding their own rotation.
+
+	FTransform ChainMotion{ FTransform::Identity };
+
+	if (bApplySpineRotation)
+	{
+		RotateChain(Output, SpineBones, SpineBonesTotalWeight, SpineYawAngle, 0.0f, ChainMotion, OutBoneTransforms);
+	}
+
+	if (bApplyLook)
+	{
+		const auto& LookState{ HumanAnimInstance->GetLookState() };
+
+		// The spine already turns the upper body, so only the remaining angle is applied to the look bones.
+
+		const auto LookYawAngle{ FMath::Clamp(FRotator3f::NormalizeAxis(LookState.YawAngle - SpineYawAngle), -LookYawAngleLimit, LookYawAngleLimit) };
+		const auto LookPitchAngle{ FMath::Clamp(LookState.PitchAngle, -LookPitchAngleLimit, LookPitchAngleLimit) };
+
+		RotateChain(Output, LookBones, LookBonesTotalWeight, LookYawAngle, LookPitchAngle, ChainMotion, OutBoneTransforms);
+
+		TRACE_ANIM_NODE_VALUE(Output, TEXT("Look Yaw Angle"), LookYawAngle);
+		TRACE_ANIM_NODE_VALUE(Output, TEXT("Look Pitch Angle"), LookPitchAngle);
+	}
+
+	OutBoneTransforms.Sort(FCompareBoneTransformIndex());
+
+	TRACE_ANIM_NODE_VALUE(Output, TEXT("Spine Yaw Angle"), SpineYawAngle);
+}
+
+bool FAnimNode_HumanSpineLook::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones)
+{
+	return (SpineBonesTotalWeight > 0.0f) || (LookBonesTotalWeight > 0.0f);
+}
+
+void FAnimNode_HumanSpineLook::InitializeBoneReferences(const FBoneContainer& RequiredBones)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(InitializeBoneReferences)
+
+	// Total weights only include the bones available in the current LOD so that the full angle is always distributed.
+
+	static const auto InitializeChain
+	{
+		[](TArray<FHumanRotationChainBone>& Bones, const FBoneContainer& RequiredBones) -> float
+		{
+			auto TotalWeight{ 0.0f };
+
+			for (auto& ChainBone : Bones)
+			{
+				ChainBone.Bone.Initialize(RequiredBones);
+
+				if (ChainBone.Bone.IsValidToEvaluate(RequiredBones))
+				{
+					TotalWeight += ChainBone.Weight;
+				}
+			}
+
+			return TotalWeight;
+		}
+	};
+
+	SpineBonesTotalWeight = InitializeChain(SpineBones, RequiredBones);
+	LookBonesTotalWeight = InitializeChain(LookBones, RequiredBones);
+}
+
+void FAnimNode_HumanSpineLook::RotateChain(FComponentSpacePoseContext& Output, const TArray<FHumanRotationChainBone>& Bones, float TotalWeight,
+	float YawAngle, float PitchAngle, FTransform& InOutChainMotion, TArray<FBoneTransform>& OutBoneTransforms) const
+{
+	if (TotalWeight <= UE_SMALL_NUMBER || (FMath::IsNearlyZero(YawAngle) && FMath::IsNearlyZero(PitchAngle)))
+	{
+		return;
+	}
+
+	const auto& BoneContainer{ Output.Pose.GetPose().GetBoneContainer() };
+
+	for (const auto& ChainBone : Bones)
+	{
+		if (!ChainBone.Bone.IsValidToEvaluate(BoneContainer))
+		{
+			continue;
+		}
+
+		const auto BoneIndex{ ChainBone.Bone.GetCompactPoseIndex(BoneContainer) };
+		const auto Ratio{ ChainBone.Weight / TotalWeight };
+
+		// Pitch is applied around the axis facing the yawed direction, then the yaw is applied around the up axis.
+
+		const FQuat YawRotation{ FVector::UpVector, FMath::DegreesToRadians(YawAngle * Ratio) };
+		const FQuat PitchRotation{ YawRotation.RotateVector(PitchAxis.GetSafeNormal()), FMath::DegreesToRadians(PitchAngle * Ratio) };
+		const auto DeltaRotation{ PitchRotation * YawRotation };
+
+		auto BoneTransform{ Output.Pose.GetComponentSpaceTransform(BoneIndex) * InOutChainMotion };
+
+		const auto PivotLocation{ BoneTransform.GetLocation() };
+
+		BoneTransform.SetRotation(DeltaRotation * BoneTransform.GetRotation());
+
+		InOutChainMotion *= FTransform{ DeltaRotation, PivotLocation - DeltaRotation.RotateVector(PivotLocation) };
+
+		OutBoneTransforms.Add(FBoneTransform(BoneIndex, BoneTransform));
+	}
+}
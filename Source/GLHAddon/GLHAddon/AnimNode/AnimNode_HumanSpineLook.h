@@ -0,0 +1,104 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "BoneControllers/AnimNode_SkeletalControlBase.h"
+
+#include "AnimNode_HumanSpineLook.generated.h"
+
+class UHumanAnimInstance;
+
+
+/**
+ * Bone and the ratio of the rotation it receives in the chain
+ */
+USTRUCT(BlueprintType)
+struct GLHADDON_API FHumanRotationChainBone
+{
+	GENERATED_BODY()
+
+public:
+	FHumanRotationChainBone() {}
+
+	FHumanRotationChainBone(const FName& InBoneName, float InWeight)
+		: Weight(InWeight)
+	{
+		Bone.BoneName = InBoneName;
+	}
+
+public:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FBoneReference Bone;
+
+	UPROPERTY(EditAnywhere, Category = "Settings", Meta = (ClampMin = 0))
+	float Weight{ 1.0f };
+
+};
+
+
+/**
+ * Anim node that distributes the spine rotation and look angles of the human character over bone chains
+ *
+ * Tips:
+ *	Can be used instead of aim offsets for characters that do not need authored look poses.
+ *	Bones of each chain must be listed from parent to child and the look chain must be below the spine chain.
+ */
+USTRUCT(BlueprintInternalUseOnly)
+struct GLHADDON_API FAnimNode_HumanSpineLook : public FAnimNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+
+public:
+	FAnimNode_HumanSpineLook();
+
+public:
+	//
+	// Bones that share SpineRotationState.YawAngle
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TArray<FHumanRotationChainBone> SpineBones;
+
+	//
+	// Bones that share the rest of the look rotation that the spine does not cover
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	TArray<FHumanRotationChainBone> LookBones;
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bApplySpineRotation{ true };
+
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	bool bApplyLook{ true };
+
+	//
+	// Axis in component space around which the pitch angle is applied. It is turned together with the yaw angle.
+	//
+	UPROPERTY(EditAnywhere, Category = "Settings", Meta = (EditCondition = "bApplyLook"))
+	FVector PitchAxis{ FVector::ForwardVector };
+
+	UPROPERTY(EditAnywhere, Category = "Settings", Meta = (ClampMin = 0, ClampMax = 180, EditCondition = "bApplyLook", ForceUnits = "deg"))
+	float LookYawAngleLimit{ 70.0f };
+
+	UPROPERTY(EditAnywhere, Category = "Settings", Meta = (ClampMin = 0, ClampMax = 90, EditCondition = "bApplyLook", ForceUnits = "deg"))
+	float LookPitchAngleLimit{ 60.0f };
+
+protected:
+	const UHumanAnimInstance* HumanAnimInstance{ nullptr };
+
+	float SpineBonesTotalWeight{ 0.0f };
+
+	float LookBonesTotalWeight{ 0.0f };
+
+public:
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+	virtual void EvaluateSkeletalControl_AnyThread(FComponentSpacePoseContext& Output, TArray<FBoneTransform>& OutBoneTransforms) override;
+	virtual bool IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) override;
+
+protected:
+	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
+
+	void RotateChain(FComponentSpacePoseContext& Output, const TArray<FHumanRotationChainBone>& Bones, float TotalWeight,
+		float YawAngle, float PitchAngle, FTransform& InOutChainMotion, TArray<FBoneTransform>& OutBoneTransforms) const;
+
+};
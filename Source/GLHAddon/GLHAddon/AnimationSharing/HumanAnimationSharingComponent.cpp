@@ -0,0 +1,100 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanAnimationSharingComponent.h"
+
+#include "AnimationSharingManager.h"
+
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanAnimationSharingComponent)
+
+
+UHumanAnimationSharingComponent::UHumanAnimationSharingComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	PrimaryComponentTick.TickInterval = 0.25f;
+
+	SetIsReplicatedByDefault(false);
+}
+
+
+void UHumanAnimationSharingComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Animation sharing is purely visual, so there is nothing to do without a camera.
+
+	if (GetNetMode() == NM_DedicatedServer || !UAnimationSharingManager::AnimationSharingEnabled())
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UHumanAnimationSharingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetRegistered(false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UHumanAnimationSharingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	FVector CameraLocation;
+
+	if (!GetCameraLocation(CameraLocation))
+	{
+		return;
+	}
+
+	const auto DistanceSquared{ FVector::DistSquared(CameraLocation, GetOwner()->GetActorLocation()) };
+
+	const auto RegisterDistance{ IndividualEvaluationDistance + (bRegistered ? 0.0f : RegistrationHysteresisDistance) };
+
+	SetRegistered(DistanceSquared > FMath::Square(RegisterDistance));
+}
+
+bool UHumanAnimationSharingComponent::GetCameraLocation(FVector& OutLocation) const
+{
+	const auto* PlayerController{ GetWorld()->GetFirstPlayerController() };
+	const auto* CameraManager{ PlayerController ? PlayerController->PlayerCameraManager.Get() : nullptr };
+
+	if (!CameraManager)
+	{
+		return false;
+	}
+
+	OutLocation = CameraManager->GetCameraLocation();
+	return true;
+}
+
+void UHumanAnimationSharingComponent::SetRegistered(bool bNewRegistered)
+{
+	if (bRegistered == bNewRegistered || !SharingSkeleton)
+	{
+		return;
+	}
+
+	auto* SharingManager{ UAnimationSharingManager::GetAnimationSharingManager(this) };
+
+	if (!SharingManager)
+	{
+		return;
+	}
+
+	if (bNewRegistered)
+	{
+		SharingManager->RegisterActorWithSkeletonBP(GetOwner(), SharingSkeleton);
+	}
+	else
+	{
+		SharingManager->UnregisterActor(GetOwner());
+	}
+
+	bRegistered = bNewRegistered;
+}
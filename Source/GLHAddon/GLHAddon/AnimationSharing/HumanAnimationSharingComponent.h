@@ -0,0 +1,57 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+
+#include "HumanAnimationSharingComponent.generated.h"
+
+class USkeleton;
+
+
+/**
+ * Component that registers the owning character to the animation sharing manager only while it is far from the camera
+ * 
+ * Tips:
+ *	Characters close to the camera are unregistered and fall back to the full individual evaluation of UHumanAnimInstance.
+ */
+UCLASS(Meta = (BlueprintSpawnableComponent))
+class GLHADDON_API UHumanAnimationSharingComponent : public UActorComponent
+{
+	GENERATED_BODY()
+public:
+	UHumanAnimationSharingComponent(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+protected:
+	//
+	// Skeleton of the Animation Sharing Setup to register with
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Animation Sharing")
+	TObjectPtr<const USkeleton> SharingSkeleton{ nullptr };
+
+	//
+	// Distance from the camera within which the character is evaluated individually
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Animation Sharing", Meta = (ClampMin = 0, ForceUnits = "cm"))
+	float IndividualEvaluationDistance{ 2000.0f };
+
+	//
+	// Additional distance required to register again, which prevents toggling around the threshold
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Animation Sharing", Meta = (ClampMin = 0, ForceUnits = "cm"))
+	float RegistrationHysteresisDistance{ 200.0f };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Animation Sharing", Transient)
+	bool bRegistered{ false };
+
+public:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+protected:
+	bool GetCameraLocation(FVector& OutLocation) const;
+
+	void SetRegistered(bool bNewRegistered);
+
+};
@@ -0,0 +1,45 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanAnimationSharingStateProcessor.h"
+
+#include "HumanAnimInstance.h"
+
+#include "Character/CharacterMeshAccessorInterface.h"
+
+#include "Components/SkeletalMeshComponent.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanAnimationSharingStateProcessor)
+
+
+UHumanAnimationSharingStateProcessor::UHumanAnimationSharingStateProcessor()
+{
+	AnimationStateEnum = StaticEnum<EHumanAnimationSharingState>();
+}
+
+
+void UHumanAnimationSharingStateProcessor::ProcessActorState_Implementation(int32& OutState, AActor* InActor, uint8 CurrentState, uint8 OnDemandState, bool& bShouldProcess)
+{
+	OutState = CurrentState;
+	bShouldProcess = false;
+
+	if (!IsValid(InActor) || !InActor->Implements<UCharacterMeshAccessorInterface>())
+	{
+		return;
+	}
+
+	const auto* Mesh{ ICharacterMeshAccessorInterface::Execute_GetMainMesh(InActor) };
+	const auto* HumanAnimInstance{ Mesh ? Cast<UHumanAnimInstance>(Mesh->GetAnimInstance()) : nullptr };
+
+	if (!HumanAnimInstance)
+	{
+		return;
+	}
+
+	OutState = static_cast<int32>(HumanAnimInstance->ComputeAnimationSharingState());
+	bShouldProcess = true;
+}
+
+UEnum* UHumanAnimationSharingStateProcessor::GetAnimationStateEnum_Implementation()
+{
+	return StaticEnum<EHumanAnimationSharingState>();
+}
@@ -0,0 +1,28 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimationSharingTypes.h"
+
+#include "HumanAnimationSharingStateProcessor.generated.h"
+
+
+/**
+ * Animation sharing state processor that maps the human locomotion of an actor to EHumanAnimationSharingState
+ * 
+ * Tips:
+ *	Use it as the state processor of the Animation Sharing Setup and assign the animations for each value of EHumanAnimationSharingState.
+ */
+UCLASS()
+class GLHADDON_API UHumanAnimationSharingStateProcessor : public UAnimationSharingStateProcessor
+{
+	GENERATED_BODY()
+public:
+	UHumanAnimationSharingStateProcessor();
+
+protected:
+	virtual void ProcessActorState_Implementation(int32& OutState, AActor* InActor, uint8 CurrentState, uint8 OnDemandState, bool& bShouldProcess) override;
+
+	virtual UEnum* GetAnimationStateEnum_Implementation() override;
+
+};
@@ -5,6 +5,14 @@
 #include "LocomotionHumanNameStatics.h"
 #include "HumanLocomotionFunctionLibrary.h"
 #include "HumanAnimInstanceProxy.h"
+#include "HumanLinkedAnimInstance.h"
+#include "HumanSkeletonCacheRegistry.h"
+#include "HumanAnimationSubsystem.h"
+#include "HumanLocomotionSpeedSettings.h"
+#include "HumanCurveSummaryUserData.h"
+#include "HumanFootstepEffectSettings.h"
+#include "AnimNode/AnimNode_HumanCycleLocomotion.h"
+#include "GLHAddonLogs.h"
 
 #include "LocomotionGeneralNameStatics.h"
 #include "LocomotionFunctionLibrary.h"
@@ -14,9 +22,78 @@
 #include "GLExtStatGroup.h"
 
 #include "Components/SkeletalMeshComponent.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Animation/AnimClassInterface.h"
+#include "Animation/AnimNode_LinkedAnimLayer.h"
+#include "Animation/AnimMontage.h"
+#include "Animation/BlendSpace.h"
+#include "Algo/Unique.h"
+#include "Algo/Find.h"
+#include "AnimNodes/AnimNode_SequenceEvaluator.h"
+#include "AnimNodes/AnimNode_PoseHandler.h"
+#include "AnimNodes/AnimNode_ModifyCurve.h"
+#include "AnimCharacterMovementLibrary.h"
+#include "Curves/CurveFloat.h"
+#include "Kismet/GameplayStatics.h"
+#include "GameFramework/PhysicsVolume.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
 
 #include UE_INLINE_GENERATED_CPP_BY_NAME(HumanAnimInstance)
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Human Redundant Look Updates Avoided"), STAT_HumanAnimInstance_RedundantLookUpdates, STATGROUP_Locomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Human Redundant Control Rig Inputs Avoided"), STAT_HumanAnimInstance_RedundantControlRigInputs, STATGROUP_Locomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Human Sleeping Updates Skipped"), STAT_HumanAnimInstance_SleepingUpdates, STATGROUP_Locomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Human Fall Asleep Count"), STAT_HumanAnimInstance_FallAsleep, STATGROUP_Locomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Human Wake Up Count"), STAT_HumanAnimInstance_WakeUp, STATGROUP_Locomotion);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Human Curve Reads Elided"), STAT_HumanAnimInstance_ElidedCurveReads, STATGROUP_Locomotion);
+
+
+// Curves read by UpdateLayering() and UpdatePose(), whose reads are elided as a group
+
+static TConstArrayView<FName> GetLayeringCurveNames()
+{
+	static const FName CurveNames[]
+	{
+		ULocomotionHumanNameStatics::LayerHeadCurveName(),
+		ULocomotionHumanNameStatics::LayerHeadAdditiveCurveName(),
+		ULocomotionHumanNameStatics::LayerHeadSlotCurveName(),
+		ULocomotionHumanNameStatics::LayerArmLeftCurveName(),
+		ULocomotionHumanNameStatics::LayerArmLeftAdditiveCurveName(),
+		ULocomotionHumanNameStatics::LayerArmLeftSlotCurveName(),
+		ULocomotionHumanNameStatics::LayerArmLeftLocalSpaceCurveName(),
+		ULocomotionHumanNameStatics::LayerArmRightCurveName(),
+		ULocomotionHumanNameStatics::LayerArmRightAdditiveCurveName(),
+		ULocomotionHumanNameStatics::LayerArmRightSlotCurveName(),
+		ULocomotionHumanNameStatics::LayerArmRightLocalSpaceCurveName(),
+		ULocomotionHumanNameStatics::LayerHandLeftCurveName(),
+		ULocomotionHumanNameStatics::LayerHandRightCurveName(),
+		ULocomotionHumanNameStatics::LayerSpineCurveName(),
+		ULocomotionHumanNameStatics::LayerSpineAdditiveCurveName(),
+		ULocomotionHumanNameStatics::LayerSpineSlotCurveName(),
+		ULocomotionHumanNameStatics::LayerPelvisCurveName(),
+		ULocomotionHumanNameStatics::LayerPelvisSlotCurveName(),
+		ULocomotionHumanNameStatics::LayerLegsCurveName(),
+		ULocomotionHumanNameStatics::LayerLegsSlotCurveName()
+	};
+
+	return CurveNames;
+}
+
+static TConstArrayView<FName> GetPoseCurveNames()
+{
+	static const FName CurveNames[]
+	{
+		ULocomotionHumanNameStatics::PoseGroundedCurveName(),
+		ULocomotionHumanNameStatics::PoseInAirCurveName(),
+		ULocomotionHumanNameStatics::PoseStandingCurveName(),
+		ULocomotionHumanNameStatics::PoseCrouchingCurveName(),
+		ULocomotionHumanNameStatics::PoseMovingCurveName(),
+		ULocomotionHumanNameStatics::PoseGaitCurveName()
+	};
+
+	return CurveNames;
+}
+
 
 UHumanAnimInstance::UHumanAnimInstance(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -28,6 +105,55 @@ FAnimInstanceProxy* UHumanAnimInstance::CreateAnimInstanceProxy()
 	return new FHumanAnimInstanceProxy(this);
 }
 
+UHumanAnimInstance* UHumanAnimInstance::GetHumanAnimInstance(const FAnimInstanceProxy* InProxy)
+{
+	if (!InProxy)
+	{
+		return nullptr;
+	}
+
+	auto* AnimInstanceObject{ const_cast<UObject*>(InProxy->GetAnimInstanceObject()) };
+
+	if (auto* HumanAnimInstance{ Cast<UHumanAnimInstance>(AnimInstanceObject) })
+	{
+		return HumanAnimInstance;
+	}
+
+	if (const auto* LinkedAnimInstance{ Cast<UHumanLinkedAnimInstance>(AnimInstanceObject) })
+	{
+		return LinkedAnimInstance->GetParentUnsafe();
+	}
+
+	return nullptr;
+}
+
+
+void UHumanAnimInstance::NativeBeginPlay()
+{
+	Super::NativeBeginPlay();
+
+	PrewarmLinkedLayerPool();
+
+	BindToBudgetedComponent();
+
+	RequestTransitionAnimations(false);
+
+	if (bLoadCrouchingTransitionAnimationsAtSpawn)
+	{
+		RequestTransitionAnimations(true);
+	}
+}
+
+void UHumanAnimInstance::NativeUninitializeAnimation()
+{
+	ReleaseTransitionAnimations();
+
+	UnbindFromBudgetedComponent();
+
+	DestroyLinkedLayerPool();
+
+	Super::NativeUninitializeAnimation();
+}
 
 void UHumanAnimInstance::UpdateAnimationOnGameThread(float DeltaTime)
 {
@@ -36,6 +162,8 @@ void UHumanAnimInstance::UpdateAnimationOnGameThread(float DeltaTime)
 		return;
 	}
 
+	UpdateQualityTierOnGameThread();
+
 	if (GetSkelMeshComponent()->IsUsingAbsoluteRotation())
 	{
 		const auto& ActorTransform{ Character->GetActorTransform() };
@@ -60,8 +188,18 @@ void UHumanAnimInstance::UpdateAnimationOnGameThread(float DeltaTime)
 	UpdateGroundedOnGameThread();
 	UpdateInAirOnGameThread();
 	UpdateInWaterOnGameThread();
+	UpdateTransitionAnimationsOnGameThread();
+	UpdateDistanceMatchingOnGameThread(DeltaTime);
+	UpdateCurveReadElisionOnGameThread(DeltaTime);
+
+	// Foot targets are read from the sockets only when the feet are updated.
+
+	if (IsCosmeticUpdateAllowed())
+	{
+		UpdateFeetOnGameThread();
+	}
 
-	UpdateFeetOnGameThread();
+	UpdateSleepOnGameThread();
 }
 
 void UHumanAnimInstance::UpdateAnimationOnThreadSafe(float DeltaTime)
@@ -71,7 +209,37 @@ void UHumanAnimInstance::UpdateAnimationOnThreadSafe(float DeltaTime)
 		return;
 	}
 
-	UpdateLayering();
+	const auto StartCycles{ FPlatformTime::Cycles64() };
+
+	ON_SCOPE_EXIT
+	{
+		// Updates that run on the game thread are already included in the tick time of the component.
+
+		if (!IsInGameThread())
+		{
+			MeasuredUpdateCycles += FPlatformTime::Cycles64() - StartCycles;
+		}
+	};
+
+	// Nothing has changed since the character went to sleep, so the states of the last update are reused.
+
+	if (UpdateSleep())
+	{
+		INC_DWORD_STAT(STAT_HumanAnimInstance_SleepingUpdates);
+		return;
+	}
+
+	// States are about to change, so the input built earlier in this frame is no longer valid.
+
+	ControlRigInputBuiltFrame = MAX_uint64;
+
+	// In the server lean mode, only the states that affect the evaluated pose are updated.
+
+	if (IsCosmeticUpdateAllowed())
+	{
+		UpdateLayering();
+	}
+
 	UpdatePose();
 
 	UpdateView(DeltaTime);
@@ -80,9 +248,13 @@ void UHumanAnimInstance::UpdateAnimationOnThreadSafe(float DeltaTime)
 	UpdateInAir(DeltaTime);
 	UpdateInWater(DeltaTime);
 
-	UpdateFeet(DeltaTime);
+	if (IsCosmeticUpdateAllowed())
+	{
+		UpdateFeet(DeltaTime);
+
+		UpdateTransitions(DeltaTime);
+	}
 
-	UpdateTransitions();
 	UpdateRotateInPlace(DeltaTime);
 }
 
@@ -95,14 +267,252 @@ void UHumanAnimInstance::OnPostEvaluateAnimation()
 
 	PlayQueuedDynamicTransitionAnimation();
 
+	DispatchFootstepsOnGameThread();
+
+	ReportMeasuredBudgetCost();
+
 	bPendingUpdate = false;
 }
 
 
+#pragma region Sleep State
+
+void UHumanAnimInstance::UpdateSleepOnGameThread()
+{
+	// Events that must be reflected immediately are checked on the game thread where montages can be safely queried.
+
+	SleepState.bWakeRequested |= bPendingUpdate || LocomotionState.bHasInput || LocomotionState.bMoving ||
+		MovementBase.bBaseChanged || (GetWorld()->TimeSince(TeleportedTime) <= 0.2f) || IsAnyMontagePlaying();
+}
+
+bool UHumanAnimInstance::UpdateSleep()
+{
+	if (!bAllowSleep)
+	{
+		SleepState.bSleeping = false;
+		SleepState.bWakeRequested = false;
+		return false;
+	}
+
+	if (SleepState.bWakeRequested || !IsQuiescent())
+	{
+		if (SleepState.bSleeping)
+		{
+			INC_DWORD_STAT(STAT_HumanAnimInstance_WakeUp);
+		}
+
+		SleepState.bSleeping = false;
+		SleepState.bWakeRequested = false;
+		SleepState.QuiescentFrames = 0;
+		SleepState.ReferenceLocation = LocomotionState.Location;
+		SleepState.ReferenceViewRotation = ViewState.Rotation;
+		CaptureReferenceCurveValues();
+		return false;
+	}
+
+	if (SleepState.bSleeping)
+	{
+		return true;
+	}
+
+	// Keep updating until the interpolated states have settled for enough frames.
+
+	if (++SleepState.QuiescentFrames < SleepQuiescentFrameCount)
+	{
+		return false;
+	}
+
+	INC_DWORD_STAT(STAT_HumanAnimInstance_FallAsleep);
+
+	SleepState.bSleeping = true;
+	return false;
+}
+
+bool UHumanAnimInstance::IsQuiescent() const
+{
+	// Compare with the reference taken when the quiescence began so that a slow drift does not keep the character asleep.
+
+	if (!LocomotionState.Location.Equals(SleepState.ReferenceLocation, SleepLocationTolerance) ||
+		!ViewState.Rotation.Equals(SleepState.ReferenceViewRotation, SleepViewRotationTolerance) ||
+		!AreCurvesQuiescent())
+	{
+		return false;
+	}
+
+	return FeetState.Left.OffsetSpringState.Velocity.IsNearlyZero(SleepFootSpringSpeedTolerance) &&
+		   FeetState.Right.OffsetSpringState.Velocity.IsNearlyZero(SleepFootSpringSpeedTolerance);
+}
+
+bool UHumanAnimInstance::AreCurvesQuiescent() const
+{
+	const auto& Curves{ GetProxyOnAnyThread<FHumanAnimInstanceProxy>().GetAnimationCurves(EAnimCurveType::AttributeCurve) };
+
+	if (Curves.Num() != SleepState.ReferenceCurveValues.Num())
+	{
+		return false;
+	}
+
+	// Each curve is compared on its own so that opposite changes in different curves cannot cancel each other out.
+
+	auto ReferenceIndex{ 0 };
+
+	for (const auto& KVP : Curves)
+	{
+		const auto& Reference{ SleepState.ReferenceCurveValues[ReferenceIndex++] };
+
+		if ((KVP.Key != Reference.Key) || !FMath::IsNearlyEqual(KVP.Value, Reference.Value, SleepCurveTolerance))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UHumanAnimInstance::CaptureReferenceCurveValues()
+{
+	const auto& Curves{ GetProxyOnAnyThread<FHumanAnimInstanceProxy>().GetAnimationCurves(EAnimCurveType::AttributeCurve) };
+
+	SleepState.ReferenceCurveValues.Reset(Curves.Num());
+
+	for (const auto& KVP : Curves)
+	{
+		SleepState.ReferenceCurveValues.Emplace(KVP.Key, KVP.Value);
+	}
+}
+
+void UHumanAnimInstance::WakeUp()
+{
+	SleepState.bWakeRequested = true;
+}
+
+#pragma endregion
+
+
+#pragma region Quality Tier
+
+void UHumanAnimInstance::BindToBudgetedComponent()
+{
+	auto* BudgetedComponent{ Cast<USkeletalMeshComponentBudgeted>(GetSkelMeshComponent()) };
+
+	if (!BudgetedComponent)
+	{
+		return;
+	}
+
+	auto& OnReduceWork{ BudgetedComponent->OnReduceWork() };
+
+	if (OnReduceWork.IsBound() && !OnReduceWork.IsBoundToObject(this))
+	{
+		GLHALOG(TEXT("OnReduceWork of %s is already bound, so %s does not reduce its work with the animation budget."),
+			*GetNameSafe(BudgetedComponent), *GetNameSafe(this));
+		return;
+	}
+
+	OnReduceWork.BindUObject(this, &ThisClass::HandleReduceWork);
+}
+
+void UHumanAnimInstance::UnbindFromBudgetedComponent()
+{
+	auto* BudgetedComponent{ Cast<USkeletalMeshComponentBudgeted>(GetSkelMeshComponent()) };
+
+	if (BudgetedComponent && BudgetedComponent->OnReduceWork().IsBoundToObject(this))
+	{
+		BudgetedComponent->OnReduceWork().Unbind();
+	}
+}
+
+void UHumanAnimInstance::HandleReduceWork(USkeletalMeshComponentBudgeted* InComponent, bool bReduceWork)
+{
+	bBudgetReduceWork = bReduceWork;
+}
+
+void UHumanAnimInstance::UpdateQualityTierOnGameThread()
+{
+	const auto* MeshComponent{ GetSkelMeshComponent() };
+	const auto* UpdateRateParams{ MeshComponent->bEnableUpdateRateOptimizations ? MeshComponent->AnimUpdateRateParams : nullptr };
+
+	const auto NetMode{ GetWorld()->GetNetMode() };
+	const auto bServerLean{ (bServerLeanOnDedicatedServer && NetMode == NM_DedicatedServer) || (bServerLeanOnListenServer && NetMode == NM_ListenServer) };
+
+	const auto PreviousQualityTier{ QualityTier };
+
+	QualityTier = bServerLean
+		? EHumanAnimQualityTier::ServerLean
+		: bBudgetReduceWork
+		? EHumanAnimQualityTier::Low
+		: (UpdateRateParams && UpdateRateParams->UpdateRate > 1)
+		? EHumanAnimQualityTier::Medium
+		: EHumanAnimQualityTier::High;
+
+	if (QualityTier == EHumanAnimQualityTier::ServerLean && PreviousQualityTier != EHumanAnimQualityTier::ServerLean)
+	{
+		ResetServerLeanStates();
+	}
+}
+
+void UHumanAnimInstance::ResetServerLeanStates()
+{
+	// States that are not updated in the server lean mode are reset so that they never hold stale values.
+
+	LayeringState = FLayeringState();
+	LookState = FLookState();
+	LeanState = FLeanState();
+	FeetState = FFeetState();
+	TransitionsState = FTransitionsState();
+	InAirState.GroundPredictionAmount = 0.0f;
+}
+
+void UHumanAnimInstance::ReportMeasuredBudgetCost()
+{
+	const auto MeasuredTimeMs{ static_cast<float>(FPlatformTime::ToMilliseconds64(MeasuredUpdateCycles)) };
+
+	MeasuredUpdateCycles = 0;
+
+	if (!bReportMeasuredBudgetCost)
+	{
+		return;
+	}
+
+	// The allocator estimates the cost of the component from its game thread tick time, which already includes the game thread update
+	// but misses the worker thread update. Adds the time spent in the worker thread update of this AnimInstance to it.
+
+	if (auto* BudgetedComponent{ Cast<USkeletalMeshComponentBudgeted>(GetSkelMeshComponent()) })
+	{
+		BudgetedComponent->SetGameThreadLastTickTimeMs(BudgetedComponent->GetGameThreadLastTickTimeMs() + MeasuredTimeMs);
+	}
+}
+
+int32 UHumanAnimInstance::GetFeetTraceInterval() const
+{
+	switch (QualityTier)
+	{
+	case EHumanAnimQualityTier::Medium:
+		return FMath::Max(MediumQualityFeetTraceInterval, 1);
+
+	case EHumanAnimQualityTier::Low:
+		return FMath::Max(LowQualityFeetTraceInterval, 1);
+
+	default:
+		return 1;
+	}
+}
+
+#pragma endregion
+
+
 #pragma region Layering State
 
 void UHumanAnimInstance::UpdateLayering()
 {
+	// Every active sequence keeps the layering curves constant, so the values of the last read are still valid.
+
+	if (bLayeringCurvesElided)
+	{
+		INC_DWORD_STAT_BY(STAT_HumanAnimInstance_ElidedCurveReads, GetLayeringCurveNames().Num());
+		return;
+	}
+
 	const auto& Curves{ GetProxyOnAnyThread<FHumanAnimInstanceProxy>().GetAnimationCurves(EAnimCurveType::AttributeCurve) };
 
 	// Lambda function to get the value of AnimCurve
@@ -154,6 +564,14 @@ void UHumanAnimInstance::UpdateLayering()
 
 void UHumanAnimInstance::UpdatePose()
 {
+	// The states below are derived only from the pose curves, so they are also still valid.
+
+	if (bPoseCurvesElided)
+	{
+		INC_DWORD_STAT_BY(STAT_HumanAnimInstance_ElidedCurveReads, GetPoseCurveNames().Num());
+		return;
+	}
+
 	const auto& Curves{ GetProxyOnAnyThread<FHumanAnimInstanceProxy>().GetAnimationCurves(EAnimCurveType::AttributeCurve) };
 
 	// Lambda function to get the value of AnimCurve
@@ -244,6 +662,38 @@ void UHumanAnimInstance::UpdateLook()
 {
 	DECLARE_SCOPE_CYCLE_COUNTER(TEXT("UHumanAnimInstance::UpdateLook()"), STAT_UHumanAnimInstance_UpdateLook, STATGROUP_Locomotion)
 
+	if (!IsCosmeticUpdateAllowed())
+	{
+		return;
+	}
+
+	// Linked layers may request the update several times in the same frame, but the result is always the same.
+
+	if (LookUpdatedFrame == GFrameCounter && !LookState.bReinitializationRequired)
+	{
+		INC_DWORD_STAT(STAT_HumanAnimInstance_RedundantLookUpdates);
+		return;
+	}
+
+	// In the low quality tier, the look is updated only once in several frames.
+
+	const auto bFirstUpdate{ LookUpdatedFrame == MAX_uint64 };
+	const auto LookUpdateInterval{ IsLookReduced() ? static_cast<uint64>(LowQualityLookUpdateInterval) : 1ull };
+	const auto ElapsedFrames{ bFirstUpdate ? LookUpdateInterval : FMath::Min(GFrameCounter - LookUpdatedFrame, LookUpdateInterval) };
+
+	if (ElapsedFrames < LookUpdateInterval && !LookState.bReinitializationRequired)
+	{
+		return;
+	}
+
+	// The frames skipped by the interval and by the update rate optimizations are both covered by the world time since the last update
+
+	const auto CurrentTime{ GetWorld()->GetTimeSeconds() };
+	const auto ElapsedTime{ bFirstUpdate ? GetDeltaSeconds() : UE_REAL_TO_FLOAT(CurrentTime - LookUpdatedTime) };
+
+	LookUpdatedFrame = GFrameCounter;
+	LookUpdatedTime = CurrentTime;
+
 	LookState.bReinitializationRequired |= bPendingUpdate;
 
 	const auto CharacterYawAngle{ UE_REAL_TO_FLOAT(LocomotionState.Rotation.Yaw) };
@@ -299,7 +749,7 @@ void UHumanAnimInstance::UpdateLook()
 			DeltaYawAngle = LocomotionState.YawSpeed > 0.0f ? FMath::Abs(DeltaYawAngle) : -FMath::Abs(DeltaYawAngle);
 		}
 
-		const auto InterpolationAmount{ ULocomotionFunctionLibrary::ExponentialDecay(GetDeltaSeconds(), InterpolationSpeed) };
+		const auto InterpolationAmount{ ULocomotionFunctionLibrary::ExponentialDecay(ElapsedTime, InterpolationSpeed) };
 
 		LookState.YawAngle = FRotator3f::NormalizeAxis(YawAngle + DeltaYawAngle * InterpolationAmount);
 		LookState.PitchAngle = ULocomotionFunctionLibrary::LerpAngle(LookState.PitchAngle, TargetPitchAngle, InterpolationAmount);
@@ -362,23 +812,7 @@ void UHumanAnimInstance::UpdateGrounded(float DeltaTime)
 		return;
 	}
 
-	// Calculate relative acceleration
-	// Indicates the current amount of acceleration/deceleration relative to the character's rotation
-	// This value is normalized from -1 to 1, where -1 is the maximum brake deceleration. 
-	// 1 equals the maximum acceleration of the character movement component.
-
-	FVector3f RelativeAccelerationAmount;
-
-	if ((LocomotionState.Acceleration | LocomotionState.Velocity) >= 0.0f)
-	{
-		RelativeAccelerationAmount = ULocomotionFunctionLibrary::ClampMagnitude01(
-			FVector3f(LocomotionState.RotationQuaternion.UnrotateVector(LocomotionState.Acceleration)) / LocomotionState.MaxAcceleration);
-	}
-	else
-	{
-		RelativeAccelerationAmount = ULocomotionFunctionLibrary::ClampMagnitude01(
-			FVector3f(LocomotionState.RotationQuaternion.UnrotateVector(LocomotionState.Acceleration)) / LocomotionState.MaxBrakingDeceleration);
-	}
+	const auto RelativeAccelerationAmount{ CalculateRelativeAccelerationAmount() };
 
 	UpdateMovementDirection();
 	UpdateVelocityBlend(DeltaTime);
@@ -429,19 +863,19 @@ void UHumanAnimInstance::UpdateVelocityBlend(float DeltaTime)
 	}
 	else
 	{
-		OnGroundState.VelocityBlend.ForwardAmount = FMath::FInterpTo(OnGroundState.VelocityBlend.ForwardAmount,
+		OnGroundState.VelocityBlend.ForwardAmount = ULocomotionFunctionLibrary::ExponentialDecay(OnGroundState.VelocityBlend.ForwardAmount,
 			ULocomotionFunctionLibrary::Clamp01(RelativeDirection.X), DeltaTime,
 			VelocityBlendInterpolationSpeed);
 
-		OnGroundState.VelocityBlend.BackwardAmount = FMath::FInterpTo(OnGroundState.VelocityBlend.BackwardAmount,
+		OnGroundState.VelocityBlend.BackwardAmount = ULocomotionFunctionLibrary::ExponentialDecay(OnGroundState.VelocityBlend.BackwardAmount,
 			FMath::Abs(FMath::Clamp(RelativeDirection.X, -1.0f, 0.0f)), DeltaTime,
 			VelocityBlendInterpolationSpeed);
 
-		OnGroundState.VelocityBlend.LeftAmount = FMath::FInterpTo(OnGroundState.VelocityBlend.LeftAmount,
+		OnGroundState.VelocityBlend.LeftAmount = ULocomotionFunctionLibrary::ExponentialDecay(OnGroundState.VelocityBlend.LeftAmount,
 			FMath::Abs(FMath::Clamp(RelativeDirection.Y, -1.0f, 0.0f)), DeltaTime,
 			VelocityBlendInterpolationSpeed);
 
-		OnGroundState.VelocityBlend.RightAmount = FMath::FInterpTo(OnGroundState.VelocityBlend.RightAmount,
+		OnGroundState.VelocityBlend.RightAmount = ULocomotionFunctionLibrary::ExponentialDecay(OnGroundState.VelocityBlend.RightAmount,
 			ULocomotionFunctionLibrary::Clamp01(RelativeDirection.Y), DeltaTime,
 			VelocityBlendInterpolationSpeed);
 	}
@@ -457,6 +891,22 @@ void UHumanAnimInstance::UpdateRotationYawOffsets()
 	OnGroundState.RotationYawOffsets.RightAngle		= RotationYawOffsetRightCurve->GetFloatValue(RotationYawOffset);
 }
 
+FVector3f UHumanAnimInstance::CalculateRelativeAccelerationAmount() const
+{
+	// Indicates the current amount of acceleration/deceleration relative to the character's rotation
+	// This value is normalized from -1 to 1, where -1 is the maximum brake deceleration. 
+	// 1 equals the maximum acceleration of the character movement component.
+
+	const FVector3f RelativeAcceleration{ LocomotionState.RotationQuaternion.UnrotateVector(LocomotionState.Acceleration) };
+
+	if ((LocomotionState.Acceleration | LocomotionState.Velocity) >= 0.0f)
+	{
+		return ULocomotionFunctionLibrary::ClampMagnitude01(RelativeAcceleration / LocomotionState.MaxAcceleration);
+	}
+
+	return ULocomotionFunctionLibrary::ClampMagnitude01(RelativeAcceleration / LocomotionState.MaxBrakingDeceleration);
+}
+
 void UHumanAnimInstance::UpdateSprint(const FVector3f& RelativeAccelerationAmount, float DeltaTime)
 {
 	if (Gait != TAG_Status_Gait_Sprinting)
@@ -472,36 +922,68 @@ void UHumanAnimInstance::UpdateSprint(const FVector3f& RelativeAccelerationAmoun
 	OnGroundState.SprintAccelerationAmount = (OnGroundState.SprintTime >= TimeThreshold) ? 0.0f : RelativeAccelerationAmount.X;
 }
 
-void UHumanAnimInstance::UpdateStrideBlendAmount()
+float UHumanAnimInstance::GetAnimatedWalkSpeed() const
 {
-	const auto Speed{ LocomotionState.Speed / LocomotionState.Scale };
-
-	const auto StandingStrideBlend{ FMath::Lerp(StrideBlendAmountWalkCurve->GetFloatValue(Speed), StrideBlendAmountRunCurve->GetFloatValue(Speed), PoseState.UnweightedGaitRunningAmount) };
+	return SpeedSettings ? SpeedSettings->AnimatedWalkSpeed : AnimatedWalkSpeed;
+}
 
-	// The amount of blend in the crouched stride.
+float UHumanAnimInstance::GetAnimatedRunSpeed() const
+{
+	return SpeedSettings ? SpeedSettings->AnimatedRunSpeed : AnimatedRunSpeed;
+}
 
-	OnGroundState.StrideBlendAmount = FMath::Lerp(StandingStrideBlend, StrideBlendAmountWalkCurve->GetFloatValue(Speed), PoseState.CrouchingAmount);
+float UHumanAnimInstance::GetAnimatedSprintSpeed() const
+{
+	return SpeedSettings ? SpeedSettings->AnimatedSprintSpeed : AnimatedSprintSpeed;
 }
 
-void UHumanAnimInstance::UpdateWalkRunBlendAmount()
+float UHumanAnimInstance::GetAnimatedCrouchSpeed() const
 {
-	// Calculates the Walk / Run blend volume. This value is used within the blend space to blend walking and running.
+	return SpeedSettings ? SpeedSettings->AnimatedCrouchSpeed : AnimatedCrouchSpeed;
+}
 
-	OnGroundState.WalkRunBlendAmount = (Gait == TAG_Status_Gait_Walking) ? 0.0f : 1.0f;
+float UHumanAnimInstance::GetStrideBlendAmountWalk(float Speed) const
+{
+	return SpeedSettings ? SpeedSettings->EvaluateStrideBlendAmountWalk(Speed) : StrideBlendAmountWalkCurve->GetFloatValue(Speed);
 }
 
-void UHumanAnimInstance::UpdateStandingPlayRate()
+float UHumanAnimInstance::GetStrideBlendAmountRun(float Speed) const
 {
-	// Calculate the standing play rate by dividing the character's speed by the animated speed of each walk.
+	return SpeedSettings ? SpeedSettings->EvaluateStrideBlendAmountRun(Speed) : StrideBlendAmountRunCurve->GetFloatValue(Speed);
+}
 
-	const auto WalkRunSpeedAmount
+void UHumanAnimInstance::UpdateStrideBlendAmount()
+{
+	const auto Speed{ LocomotionState.Speed / LocomotionState.Scale };
+
+	const auto StrideBlendAmountWalk{ GetStrideBlendAmountWalk(Speed) };
+
+	const auto StandingStrideBlend{ FMath::Lerp(StrideBlendAmountWalk, GetStrideBlendAmountRun(Speed), PoseState.UnweightedGaitRunningAmount) };
+
+	// The amount of blend in the crouched stride.
+
+	OnGroundState.StrideBlendAmount = FMath::Lerp(StandingStrideBlend, StrideBlendAmountWalk, PoseState.CrouchingAmount);
+}
+
+void UHumanAnimInstance::UpdateWalkRunBlendAmount()
+{
+	// Calculates the Walk / Run blend volume. This value is used within the blend space to blend walking and running.
+
+	OnGroundState.WalkRunBlendAmount = (Gait == TAG_Status_Gait_Walking) ? 0.0f : 1.0f;
+}
+
+void UHumanAnimInstance::UpdateStandingPlayRate()
+{
+	// Calculate the standing play rate by dividing the character's speed by the animated speed of each walk.
+
+	const auto WalkRunSpeedAmount
 	{ 
-		FMath::Lerp(LocomotionState.Speed / AnimatedWalkSpeed, LocomotionState.Speed / AnimatedRunSpeed, PoseState.UnweightedGaitRunningAmount)
+		FMath::Lerp(LocomotionState.Speed / GetAnimatedWalkSpeed(), LocomotionState.Speed / GetAnimatedRunSpeed(), PoseState.UnweightedGaitRunningAmount)
 	};
 
 	const auto WalkRunSprintSpeedAmount
 	{ 
-		FMath::Lerp(WalkRunSpeedAmount, LocomotionState.Speed / AnimatedSprintSpeed, PoseState.UnweightedGaitSprintingAmount)
+		FMath::Lerp(WalkRunSpeedAmount, LocomotionState.Speed / GetAnimatedSprintSpeed(), PoseState.UnweightedGaitSprintingAmount)
 	};
 
 	OnGroundState.StandingPlayRate = FMath::Clamp(WalkRunSprintSpeedAmount / (OnGroundState.StrideBlendAmount * LocomotionState.Scale), 0.0f, 3.0f);
@@ -509,11 +991,16 @@ void UHumanAnimInstance::UpdateStandingPlayRate()
 
 void UHumanAnimInstance::UpdateCrouchingPlayRate()
 {
-	OnGroundState.CrouchingPlayRate = FMath::Clamp(LocomotionState.Speed / (AnimatedCrouchSpeed * OnGroundState.StrideBlendAmount * LocomotionState.Scale), 0.0f, 2.0f);
+	OnGroundState.CrouchingPlayRate = FMath::Clamp(LocomotionState.Speed / (GetAnimatedCrouchSpeed() * OnGroundState.StrideBlendAmount * LocomotionState.Scale), 0.0f, 2.0f);
 }
 
 void UHumanAnimInstance::UpdateGroundedLeanAmount(const FVector3f& RelativeAccelerationAmount, float DeltaTime)
 {
+	if (!IsCosmeticUpdateAllowed())
+	{
+		return;
+	}
+
 	if (bPendingUpdate)
 	{
 		LeanState.RightAmount = RelativeAccelerationAmount.Y;
@@ -521,13 +1008,18 @@ void UHumanAnimInstance::UpdateGroundedLeanAmount(const FVector3f& RelativeAccel
 	}
 	else
 	{
-		LeanState.RightAmount = FMath::FInterpTo(LeanState.RightAmount, RelativeAccelerationAmount.Y, DeltaTime, LeanInterpolationSpeed);
-		LeanState.ForwardAmount = FMath::FInterpTo(LeanState.ForwardAmount, RelativeAccelerationAmount.X, DeltaTime, LeanInterpolationSpeed);
+		LeanState.RightAmount = ULocomotionFunctionLibrary::ExponentialDecay(LeanState.RightAmount, RelativeAccelerationAmount.Y, DeltaTime, LeanInterpolationSpeed);
+		LeanState.ForwardAmount = ULocomotionFunctionLibrary::ExponentialDecay(LeanState.ForwardAmount, RelativeAccelerationAmount.X, DeltaTime, LeanInterpolationSpeed);
 	}
 }
 
 void UHumanAnimInstance::ResetGroundedLeanAmount(float DeltaTime)
 {
+	if (!IsCosmeticUpdateAllowed())
+	{
+		return;
+	}
+
 	if (bPendingUpdate)
 	{
 		LeanState.RightAmount = 0.0f;
@@ -535,8 +1027,8 @@ void UHumanAnimInstance::ResetGroundedLeanAmount(float DeltaTime)
 	}
 	else
 	{
-		LeanState.RightAmount = FMath::FInterpTo(LeanState.RightAmount, 0.0f, DeltaTime, LeanInterpolationSpeed);
-		LeanState.ForwardAmount = FMath::FInterpTo(LeanState.ForwardAmount, 0.0f, DeltaTime, LeanInterpolationSpeed);
+		LeanState.RightAmount = ULocomotionFunctionLibrary::ExponentialDecay(LeanState.RightAmount, 0.0f, DeltaTime, LeanInterpolationSpeed);
+		LeanState.ForwardAmount = ULocomotionFunctionLibrary::ExponentialDecay(LeanState.ForwardAmount, 0.0f, DeltaTime, LeanInterpolationSpeed);
 	}
 }
 
@@ -592,7 +1084,7 @@ void UHumanAnimInstance::UpdateGroundPredictionAmount()
 	static constexpr auto MinSweepDistance{ 150.0f };
 	static constexpr auto MaxSweepDistance{ 2000.0f };
 
-	if (InAirState.VerticalVelocity > VerticalVelocityThreshold)
+	if (!IsGroundPredictionAllowed() || InAirState.VerticalVelocity > VerticalVelocityThreshold)
 	{
 		InAirState.GroundPredictionAmount = 0.0f;
 		return;
@@ -633,6 +1125,11 @@ void UHumanAnimInstance::UpdateGroundPredictionAmount()
 
 void UHumanAnimInstance::UpdateInAirLeanAmount(float DeltaTime)
 {
+	if (!IsCosmeticUpdateAllowed())
+	{
+		return;
+	}
+
 	// Use the direction and amount of relative velocity to determine how much the character will tilt
 
 	static constexpr auto ReferenceSpeed{ 350.0f };
@@ -649,10 +1146,70 @@ void UHumanAnimInstance::UpdateInAirLeanAmount(float DeltaTime)
 	}
 	else
 	{
-		LeanState.RightAmount = FMath::FInterpTo(LeanState.RightAmount, RelativeVelocity.Y, DeltaTime, LeanInterpolationSpeed);
+		LeanState.RightAmount = ULocomotionFunctionLibrary::ExponentialDecay(LeanState.RightAmount, RelativeVelocity.Y, DeltaTime, LeanInterpolationSpeed);
+
+		LeanState.ForwardAmount = ULocomotionFunctionLibrary::ExponentialDecay(LeanState.ForwardAmount, RelativeVelocity.X, DeltaTime, LeanInterpolationSpeed);
+	}
+}
+
+#pragma endregion
+
+
+#pragma region InWater
+
+void UHumanAnimInstance::UpdateInWaterOnGameThread()
+{
+	check(IsInGameThread());
+
+	InWaterState.bSwimming = CharacterMovement->IsSwimming();
+
+	const auto* Volume{ InWaterState.bSwimming ? CharacterMovement->GetPhysicsVolume() : nullptr };
+
+	if (!Volume || !Volume->bWaterVolume)
+	{
+		return;
+	}
+
+	// The volume is the one already found by the movement component, and its surface is shared by the swimmers in the same cell
+
+	auto* Subsystem{ UHumanAnimationSubsystem::Get(GetWorld()) };
+
+	if (!Subsystem)
+	{
+		InWaterState.SurfaceHeight = UHumanAnimationSubsystem::QueryWaterSurfaceHeight(Volume, LocomotionState.Location);
+		return;
+	}
 
-		LeanState.ForwardAmount = FMath::FInterpTo(LeanState.ForwardAmount, RelativeVelocity.X, DeltaTime, LeanInterpolationSpeed);
+	InWaterState.SurfaceHeight = Subsystem->FindOrQueryWaterSurfaceHeight(Volume, Subsystem->GetWaterSurfaceCell(LocomotionState.Location));
+}
+
+void UHumanAnimInstance::UpdateInWater(float DeltaTime)
+{
+	if (!InWaterState.bSwimming)
+	{
+		InWaterState.bUnderwater = false;
+		InWaterState.SubmersionDepth = 0.0f;
+		InWaterState.SubmersionAmount = 0.0f;
+		InWaterState.StrokePlayRate = 1.0f;
+		return;
 	}
+
+	const auto CapsuleBottomHeight{ UE_REAL_TO_FLOAT(LocomotionState.Location.Z) - LocomotionState.CapsuleHalfHeight };
+	const auto SubmergedHeight{ InWaterState.SurfaceHeight - CapsuleBottomHeight };
+
+	InWaterState.SubmersionDepth = SubmergedHeight / LocomotionState.Scale;
+	InWaterState.SubmersionAmount = FMath::Clamp(SubmergedHeight / (2.0f * LocomotionState.CapsuleHalfHeight), 0.0f, 1.0f);
+	InWaterState.bUnderwater = FAnimWeight::IsFullWeight(InWaterState.SubmersionAmount);
+
+	// Strokes are played at the rate that matches the swim speed, and at the normal rate while treading water
+
+	InWaterState.StrokePlayRate = LocomotionState.bMoving
+		? FMath::Clamp(LocomotionState.Speed / (AnimatedSwimSpeed * LocomotionState.Scale), SwimStrokePlayRate.X, SwimStrokePlayRate.Y)
+		: 1.0f;
+
+	// Same as on the ground, the character leans in the direction of the acceleration relative to its rotation
+
+	UpdateGroundedLeanAmount(CalculateRelativeAccelerationAmount(), DeltaTime);
 }
 
 #pragma endregion
@@ -666,11 +1223,28 @@ void UHumanAnimInstance::UpdateFeetOnGameThread()
 
 	const auto* Mesh{ GetSkelMeshComponent() };
 
+	// Bone indices are resolved once per mesh asset and shared, so the transforms are read by index instead of by name.
+
+	if (!MeshBoneCache.IsValid() || !MeshBoneCache->IsValidFor(Mesh->GetSkinnedAsset()))
+	{
+		MeshBoneCache = FHumanSkeletonCacheRegistry::Get().FindOrAddMeshBoneCache(Mesh->GetSkinnedAsset());
+	}
+
+	const auto GetBoneTransform
+	{
+		[this, Mesh](EHumanCachedBone Bone, const FName& BoneName) -> FTransform
+		{
+			const auto BoneIndex{ MeshBoneCache.IsValid() ? MeshBoneCache->GetBoneIndex(Bone) : INDEX_NONE };
+
+			return (BoneIndex != INDEX_NONE) ? Mesh->GetBoneTransform(BoneIndex) : Mesh->GetSocketTransform(BoneName);
+		}
+	};
+
 	const auto FootLeftTargetTransform
 	{
-		Mesh->GetSocketTransform(bUseFootIkBones
-									 ? ULocomotionHumanNameStatics::FootLeftIkBoneName()
-									 : ULocomotionHumanNameStatics::FootLeftVirtualBoneName())
+		bUseFootIkBones
+		? GetBoneTransform(EHumanCachedBone::FootLeftIk, ULocomotionHumanNameStatics::FootLeftIkBoneName())
+		: GetBoneTransform(EHumanCachedBone::FootLeftVirtual, ULocomotionHumanNameStatics::FootLeftVirtualBoneName())
 	};
 
 	FeetState.Left.TargetLocation = FootLeftTargetTransform.GetLocation();
@@ -678,9 +1252,9 @@ void UHumanAnimInstance::UpdateFeetOnGameThread()
 
 	const auto FootRightTargetTransform
 	{
-		Mesh->GetSocketTransform(bUseFootIkBones
-									 ? ULocomotionHumanNameStatics::FootRightIkBoneName()
-									 : ULocomotionHumanNameStatics::FootRightVirtualBoneName())
+		bUseFootIkBones
+		? GetBoneTransform(EHumanCachedBone::FootRightIk, ULocomotionHumanNameStatics::FootRightIkBoneName())
+		: GetBoneTransform(EHumanCachedBone::FootRightVirtual, ULocomotionHumanNameStatics::FootRightVirtualBoneName())
 	};
 
 	FeetState.Right.TargetLocation = FootRightTargetTransform.GetLocation();
@@ -694,6 +1268,11 @@ void UHumanAnimInstance::UpdateFeet(float DeltaTime)
 
 	FeetState.MinMaxPelvisOffsetZ = FVector2D::ZeroVector;
 
+	// In the lower quality tiers, the feet are traced only once in several updates and the offset targets are reused in between.
+
+	FeetTraceCounter = (FeetTraceCounter + 1) % GetFeetTraceInterval();
+	bTraceFeetThisUpdate = bPendingUpdate || (FeetTraceCounter == 0);
+
 	const auto ComponentTransformInverse{ GetProxyOnAnyThread<FAnimInstanceProxy>().GetComponentTransform().Inverse() };
 
 	UpdateFoot(FeetState.Left, ULocomotionHumanNameStatics::FootLeftIkCurveName(),
@@ -707,6 +1286,11 @@ void UHumanAnimInstance::UpdateFeet(float DeltaTime)
 
 	FeetState.MinMaxPelvisOffsetZ.Y = FMath::Max(FeetState.Left.OffsetTargetLocation.Z, FeetState.Right.OffsetTargetLocation.Z) /
 												 LocomotionState.Scale;
+
+	if (bEnableFootsteps)
+	{
+		UpdateFootsteps(DeltaTime);
+	}
 }
 
 void UHumanAnimInstance::UpdateFoot(FFootState& FootState, const FName& FootIkCurveName, const FName& FootLockCurveName, const FTransform& ComponentTransformInverse, float DeltaTime) const
@@ -878,6 +1462,8 @@ void UHumanAnimInstance::UpdateFootLock(FFootState& FootState, const FName& Foot
 
 void UHumanAnimInstance::UpdateFootOffset(FFootState& FootState, float DeltaTime, FVector& FinalLocation, FQuat& FinalRotation) const
 {
+	FootState.bSurfaceUpToDate = false;
+
 	if (!FAnimWeight::IsRelevant(FootState.IkAmount))
 	{
 		FootState.OffsetTargetLocation = FVector::ZeroVector;
@@ -901,8 +1487,10 @@ void UHumanAnimInstance::UpdateFootOffset(FFootState& FootState, float DeltaTime
 		{
 			static constexpr auto InterpolationSpeed{ 15.0f };
 
-			FootState.OffsetLocation = FMath::VInterpTo(FootState.OffsetLocation, FVector::ZeroVector, DeltaTime, InterpolationSpeed);
-			FootState.OffsetRotation = FMath::QInterpTo(FootState.OffsetRotation, FQuat::Identity, DeltaTime, InterpolationSpeed);
+			const auto InterpolationAmount{ ULocomotionFunctionLibrary::ExponentialDecay(DeltaTime, InterpolationSpeed) };
+
+			FootState.OffsetLocation = FMath::Lerp(FootState.OffsetLocation, FVector::ZeroVector, InterpolationAmount);
+			FootState.OffsetRotation = FQuat::Slerp(FootState.OffsetRotation, FQuat::Identity, InterpolationAmount);
 
 			FinalLocation += FootState.OffsetLocation;
 			FinalRotation = FootState.OffsetRotation * FinalRotation;
@@ -913,15 +1501,26 @@ void UHumanAnimInstance::UpdateFootOffset(FFootState& FootState, float DeltaTime
 
 	// Trace down from the foot location to find the geometry. If the surface is walkable, save the impact location and normals
 
+	if (!bTraceFeetThisUpdate)
+	{
+		ApplyFootOffset(FootState, DeltaTime, FinalLocation, FinalRotation);
+		return;
+	}
+
 	const FVector TraceLocation{ FinalLocation.X, FinalLocation.Y, GetProxyOnAnyThread<FAnimInstanceProxy>().GetComponentTransform().GetLocation().Z };
 
+	// The physical material is also returned so that the footsteps can reuse this trace
+
+	FCollisionQueryParams QueryParams(__FUNCTION__, true, Character);
+	QueryParams.bReturnPhysicalMaterial = bEnableFootsteps;
+
 	FHitResult Hit;
 	GetWorld()->LineTraceSingleByChannel(
 		Hit,
 		TraceLocation + FVector(0.0f, 0.0f, IkTraceDistanceUpward* LocomotionState.Scale),
 		TraceLocation - FVector(0.0f, 0.0f, IkTraceDistanceDownward * LocomotionState.Scale),
 		UEngineTypes::ConvertToCollisionChannel(IkTraceChannel),
-		FCollisionQueryParams(__FUNCTION__, true, Character));
+		QueryParams);
 
 	const auto bGroundValid{ Hit.IsValidBlockingHit() && Hit.ImpactNormal.Z >= LocomotionState.WalkableFloorZ };
 
@@ -940,8 +1539,23 @@ void UHumanAnimInstance::UpdateFootOffset(FFootState& FootState, float DeltaTime
 			-ULocomotionFunctionLibrary::DirectionToAngle(FVector2D(Hit.ImpactNormal.Z, Hit.ImpactNormal.X)),
 			0.0f,
 			ULocomotionFunctionLibrary::DirectionToAngle(FVector2D(Hit.ImpactNormal.Z, Hit.ImpactNormal.Y))).Quaternion();
+
+		FootState.SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+		FootState.SurfaceNormal = Hit.ImpactNormal;
+	}
+	else
+	{
+		FootState.SurfaceType = SurfaceType_Default;
+		FootState.SurfaceNormal = FVector::UpVector;
 	}
 
+	FootState.bSurfaceUpToDate = true;
+
+	ApplyFootOffset(FootState, DeltaTime, FinalLocation, FinalRotation);
+}
+
+void UHumanAnimInstance::ApplyFootOffset(FFootState& FootState, float DeltaTime, FVector& FinalLocation, FQuat& FinalRotation) const
+{
 	// Interpolate current offset to new target value
 
 	if (bPendingUpdate)
@@ -963,8 +1577,8 @@ void UHumanAnimInstance::UpdateFootOffset(FFootState& FootState, float DeltaTime
 
 		static constexpr auto RotationInterpolationSpeed{ 30.0f };
 
-		FootState.OffsetRotation = FMath::QInterpTo(FootState.OffsetRotation, FootState.OffsetTargetRotation,
-			DeltaTime, RotationInterpolationSpeed);
+		FootState.OffsetRotation = FQuat::Slerp(FootState.OffsetRotation, FootState.OffsetTargetRotation,
+			ULocomotionFunctionLibrary::ExponentialDecay(DeltaTime, RotationInterpolationSpeed));
 	}
 
 	FinalLocation += FootState.OffsetLocation;
@@ -974,44 +1588,168 @@ void UHumanAnimInstance::UpdateFootOffset(FFootState& FootState, float DeltaTime
 #pragma endregion
 
 
-#pragma region Transitions
+#pragma region Footsteps
 
-void UHumanAnimInstance::PlayQuickStopAnimation()
+void UHumanAnimInstance::UpdateFootsteps(float DeltaTime)
+{
+	const auto bFootstepsAllowed{ !bPendingUpdate && (LocomotionMode == TAG_Status_LocomotionMode_OnGround) };
+	const auto SoundBlockAmount{ GetCurveValueClamped01(ULocomotionGeneralNameStatics::FootstepSoundBlockCurveName()) };
+	const auto& ComponentTransform{ GetProxyOnAnyThread<FAnimInstanceProxy>().GetComponentTransform() };
+
+	const auto UpdateFootstep
+	{
+		[&](const FFootState& FootState, bool bLeftFoot, float NewPlantedAmount, float& PlantedAmount, float& CooldownTime)
+		{
+			const auto bPlanted{ (NewPlantedAmount >= FootstepPlantThreshold) && (PlantedAmount < FootstepPlantThreshold) };
+
+			PlantedAmount = NewPlantedAmount;
+			CooldownTime = FMath::Max(0.0f, CooldownTime - DeltaTime);
+
+			if (!bPlanted || !bFootstepsAllowed || (CooldownTime > 0.0f))
+			{
+				return;
+			}
+
+			CooldownTime = FootstepMinInterval;
+
+			auto& Event{ FootstepState.PendingEvents.AddDefaulted_GetRef() };
+			Event.bLeftFoot = bLeftFoot;
+			Event.Location = ComponentTransform.TransformPosition(FootState.IkLocation);
+
+			// The surface of the IK trace may be from an earlier update, when the foot was over another surface
+
+			if (FootState.bSurfaceUpToDate)
+			{
+				Event.SurfaceNormal = FootState.SurfaceNormal;
+				Event.SurfaceType = FootState.SurfaceType;
+			}
+			else
+			{
+				TraceFootstepSurface(Event.Location, Event.SurfaceType, Event.SurfaceNormal);
+			}
+
+			Event.Speed = LocomotionState.Speed;
+			Event.SoundBlockAmount = SoundBlockAmount;
+		}
+	};
+
+	// A foot is planted while its foot lock curve or its side of the foot planted curve is high.
+	// The foot planted curve is needed because the foot lock fades out while moving.
+
+	UpdateFootstep(FeetState.Left, true,
+		FMath::Max(GetCurveValueClamped01(ULocomotionHumanNameStatics::FootLeftLockCurveName()), -FeetState.FootPlantedAmount),
+		FootstepState.LeftPlantedAmount, FootstepState.LeftCooldownTime);
+
+	UpdateFootstep(FeetState.Right, false,
+		FMath::Max(GetCurveValueClamped01(ULocomotionHumanNameStatics::FootRightLockCurveName()), FeetState.FootPlantedAmount),
+		FootstepState.RightPlantedAmount, FootstepState.RightCooldownTime);
+}
+
+void UHumanAnimInstance::TraceFootstepSurface(const FVector& Location, TEnumAsByte<EPhysicalSurface>& OutSurfaceType, FVector& OutSurfaceNormal) const
+{
+	FCollisionQueryParams QueryParams(__FUNCTION__, true, Character);
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	FHitResult Hit;
+	GetWorld()->LineTraceSingleByChannel(
+		Hit,
+		Location + FVector(0.0f, 0.0f, IkTraceDistanceUpward * LocomotionState.Scale),
+		Location - FVector(0.0f, 0.0f, IkTraceDistanceDownward * LocomotionState.Scale),
+		UEngineTypes::ConvertToCollisionChannel(IkTraceChannel),
+		QueryParams);
+
+	if (Hit.IsValidBlockingHit() && Hit.ImpactNormal.Z >= LocomotionState.WalkableFloorZ)
+	{
+		OutSurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+		OutSurfaceNormal = Hit.ImpactNormal;
+	}
+	else
+	{
+		OutSurfaceType = SurfaceType_Default;
+		OutSurfaceNormal = FVector::UpVector;
+	}
+}
+
+void UHumanAnimInstance::DispatchFootstepsOnGameThread()
 {
-	if (RotationMode != TAG_Status_RotationMode_VelocityDirection)
+	check(IsInGameThread());
+
+	if (FootstepState.PendingEvents.IsEmpty())
 	{
-		PlayTransitionLeftAnimation(QuickStopBlendInDuration, QuickStopBlendOutDuration, QuickStopPlayRate.X, QuickStopStartTime);
 		return;
 	}
 
-	auto RotationYawAngle{ FRotator3f::NormalizeAxis(UE_REAL_TO_FLOAT((LocomotionState.bHasInput ? LocomotionState.InputYawAngle : LocomotionState.TargetYawAngle) - LocomotionState.Rotation.Yaw)) };
+	if (FootstepEffectSettings)
+	{
+		for (const auto& Event : FootstepState.PendingEvents)
+		{
+			PlayFootstepEffect(Event);
+		}
+	}
+
+	OnFootsteps.Broadcast(FootstepState.PendingEvents);
+
+	FootstepState.PendingEvents.Reset();
+}
+
+void UHumanAnimInstance::PlayFootstepEffect(const FHumanFootstepEvent& Event)
+{
+	const auto& Effect{ FootstepEffectSettings->FindEffect(Event.SurfaceType) };
+	const auto Volume{ Effect.VolumeMultiplier * (1.0f - Event.SoundBlockAmount) };
 
-	if (RotationYawAngle > 180.0f - ULocomotionFunctionLibrary::CounterClockwiseRotationAngleThreshold)
+	if (!Effect.Sound || (Volume <= UE_KINDA_SMALL_NUMBER))
 	{
-		RotationYawAngle -= 360.0f;
+		return;
 	}
 
-	// Adjust the playback speed of the quick stop animation based on the distance of the character
+	// Fire and forget, so that a footstep does not cut off the tail of the previous one
+
+	UGameplayStatics::PlaySoundAtLocation(this, Effect.Sound, Event.Location, FRotator::ZeroRotator,
+		Volume, Effect.PitchMultiplier, 0.0f, FootstepEffectSettings->GetSoundAttenuation());
+}
+
+#pragma endregion
+
+
+#pragma region Transitions
+
+void UHumanAnimInstance::PlayQuickStopAnimation()
+{
+	const auto& TransitionAnimations{ GetTransitionAnimations() };
 
-	if (RotationYawAngle <= 0.0f)
+	auto* Animation{ TransitionAnimations.TransitionLeftAnimation.Get() };
+	auto PlayRate{ QuickStopPlayRate.X };
+
+	if (RotationMode == TAG_Status_RotationMode_VelocityDirection)
 	{
-		PlayTransitionLeftAnimation(QuickStopBlendInDuration, QuickStopBlendOutDuration,
-			FMath::Lerp(QuickStopPlayRate.X, QuickStopPlayRate.Y,
-				FMath::Abs(RotationYawAngle) / 180.0f), QuickStopStartTime);
+		auto RotationYawAngle{ FRotator3f::NormalizeAxis(UE_REAL_TO_FLOAT((LocomotionState.bHasInput ? LocomotionState.InputYawAngle : LocomotionState.TargetYawAngle) - LocomotionState.Rotation.Yaw)) };
+
+		if (RotationYawAngle > 180.0f - ULocomotionFunctionLibrary::CounterClockwiseRotationAngleThreshold)
+		{
+			RotationYawAngle -= 360.0f;
+		}
+
+		// Adjust the playback speed of the quick stop animation based on the distance of the character
+
+		Animation = (RotationYawAngle <= 0.0f) ? TransitionAnimations.TransitionLeftAnimation.Get() : TransitionAnimations.TransitionRightAnimation.Get();
+		PlayRate = FMath::Lerp(QuickStopPlayRate.X, QuickStopPlayRate.Y, FMath::Abs(RotationYawAngle) / 180.0f);
 	}
-	else
+
+	// Animations with the distance to marker curve follow the actual stop of the character instead of the play rate
+
+	if (bUseDistanceMatching && PlayDistanceMatchedTransitionAnimation(Animation, QuickStopBlendInDuration, QuickStopBlendOutDuration))
 	{
-		PlayTransitionRightAnimation(QuickStopBlendInDuration, QuickStopBlendOutDuration,
-			FMath::Lerp(QuickStopPlayRate.X, QuickStopPlayRate.Y,
-				FMath::Abs(RotationYawAngle) / 180.0f), QuickStopStartTime);
+		return;
 	}
+
+	PlayTransitionAnimation(Animation, QuickStopBlendInDuration, QuickStopBlendOutDuration, PlayRate, QuickStopStartTime);
 }
 
 void UHumanAnimInstance::PlayTransitionAnimation(UAnimSequenceBase* Animation, float BlendInDuration, float BlendOutDuration, float PlayRate, float StartTime, bool bFromStandingIdleOnly)
 {
 	check(IsInGameThread());
 
-	if (!IsValid(CharacterMovement))
+	if (!IsValid(CharacterMovement) || !IsCosmeticUpdateAllowed())
 	{
 		return;
 	}
@@ -1021,22 +1759,18 @@ void UHumanAnimInstance::PlayTransitionAnimation(UAnimSequenceBase* Animation, f
 		return;
 	}
 
-	PlaySlotAnimationAsDynamicMontage(Animation, ULocomotionHumanNameStatics::TransitionSlotName(), BlendInDuration, BlendOutDuration, PlayRate, 1, 0.0f, StartTime);
+	PlayPooledTransitionMontage(Animation, BlendInDuration, BlendOutDuration, PlayRate, StartTime);
 }
 
 void UHumanAnimInstance::PlayTransitionLeftAnimation(float BlendInDuration, float BlendOutDuration, float PlayRate, float StartTime, bool bFromStandingIdleOnly)
 {
-	PlayTransitionAnimation(Stance == TAG_Status_Stance_Crouching
-		? CrouchingTransitionLeftAnimation
-		: StandingTransitionLeftAnimation,
+	PlayTransitionAnimation(GetTransitionAnimations().TransitionLeftAnimation,
 		BlendInDuration, BlendOutDuration, PlayRate, StartTime, bFromStandingIdleOnly);
 }
 
 void UHumanAnimInstance::PlayTransitionRightAnimation(float BlendInDuration, float BlendOutDuration, float PlayRate, float StartTime, bool bFromStandingIdleOnly)
 {
-	PlayTransitionAnimation(Stance == TAG_Status_Stance_Crouching
-		? CrouchingTransitionRightAnimation
-		: StandingTransitionRightAnimation,
+	PlayTransitionAnimation(GetTransitionAnimations().TransitionRightAnimation,
 		BlendInDuration, BlendOutDuration, PlayRate, StartTime, bFromStandingIdleOnly);
 }
 
@@ -1047,24 +1781,134 @@ void UHumanAnimInstance::StopTransitionAndTurnInPlaceAnimations(float BlendOutDu
 	StopSlotAnimation(BlendOutDuration, ULocomotionHumanNameStatics::TransitionSlotName());
 }
 
-void UHumanAnimInstance::UpdateTransitions()
+void UHumanAnimInstance::RequestTransitionAnimations(bool bCrouching)
+{
+	check(IsInGameThread());
+
+	auto& Set{ bCrouching ? CrouchingTransitionAnimations : StandingTransitionAnimations };
+
+	if (Set.bRequested)
+	{
+		return;
+	}
+
+	Set.bRequested = true;
+
+	const FSoftObjectPath Paths[]
+	{
+		(bCrouching ? CrouchingTransitionLeftAnimation : StandingTransitionLeftAnimation).ToSoftObjectPath(),
+		(bCrouching ? CrouchingTransitionRightAnimation : StandingTransitionRightAnimation).ToSoftObjectPath(),
+		(bCrouching ? CrouchingDynamicTransitionLeftAnimation : StandingDynamicTransitionLeftAnimation).ToSoftObjectPath(),
+		(bCrouching ? CrouchingDynamicTransitionRightAnimation : StandingDynamicTransitionRightAnimation).ToSoftObjectPath()
+	};
+
+	// Without the subsystem (e.g. in tools) only the animations that are already loaded are used.
+
+	if (auto* Subsystem{ UHumanAnimationSubsystem::Get(GetWorld()) })
+	{
+		TransitionAnimationCache = Subsystem;
+
+		Subsystem->AcquireAnimations(Paths);
+
+		for (const auto& Path : Paths)
+		{
+			if (!Path.IsNull())
+			{
+				AcquiredTransitionAnimationPaths.Add(Path);
+			}
+		}
+	}
+
+	ResolveTransitionAnimations(Set, bCrouching);
+}
+
+void UHumanAnimInstance::ReleaseTransitionAnimations()
+{
+	if (auto* Subsystem{ TransitionAnimationCache.Get() })
+	{
+		Subsystem->ReleaseAnimations(AcquiredTransitionAnimationPaths);
+	}
+
+	AcquiredTransitionAnimationPaths.Reset();
+	TransitionAnimationCache.Reset();
+
+	StandingTransitionAnimations = FTransitionAnimationSet();
+	CrouchingTransitionAnimations = FTransitionAnimationSet();
+}
+
+void UHumanAnimInstance::UpdateTransitionAnimationsOnGameThread()
+{
+	// The standing animations are requested again if the instance has been reinitialized, and the crouching ones on the first crouch.
+
+	RequestTransitionAnimations(false);
+
+	if (Stance == TAG_Status_Stance_Crouching)
+	{
+		RequestTransitionAnimations(true);
+	}
+
+	if (StandingTransitionAnimations.bPending)
+	{
+		ResolveTransitionAnimations(StandingTransitionAnimations, false);
+	}
+
+	if (CrouchingTransitionAnimations.bPending)
+	{
+		ResolveTransitionAnimations(CrouchingTransitionAnimations, true);
+	}
+}
+
+void UHumanAnimInstance::ResolveTransitionAnimations(FTransitionAnimationSet& Set, bool bCrouching) const
+{
+	check(IsInGameThread());
+
+	auto bPending{ false };
+
+	const auto Resolve
+	{
+		[&bPending](const TSoftObjectPtr<UAnimSequenceBase>& SoftAnimation, TObjectPtr<UAnimSequenceBase>& OutAnimation)
+		{
+			if (!OutAnimation && !SoftAnimation.IsNull())
+			{
+				OutAnimation = SoftAnimation.Get();
+				bPending |= !OutAnimation;
+			}
+		}
+	};
+
+	Resolve(bCrouching ? CrouchingTransitionLeftAnimation : StandingTransitionLeftAnimation, Set.TransitionLeftAnimation);
+	Resolve(bCrouching ? CrouchingTransitionRightAnimation : StandingTransitionRightAnimation, Set.TransitionRightAnimation);
+	Resolve(bCrouching ? CrouchingDynamicTransitionLeftAnimation : StandingDynamicTransitionLeftAnimation, Set.DynamicTransitionLeftAnimation);
+	Resolve(bCrouching ? CrouchingDynamicTransitionRightAnimation : StandingDynamicTransitionRightAnimation, Set.DynamicTransitionRightAnimation);
+
+	// Without the subsystem nothing is streamed in, so the set is not polled.
+
+	Set.bPending = bPending && TransitionAnimationCache.IsValid();
+}
+
+const FTransitionAnimationSet& UHumanAnimInstance::GetTransitionAnimations() const
+{
+	return (Stance == TAG_Status_Stance_Crouching) ? CrouchingTransitionAnimations : StandingTransitionAnimations;
+}
+
+void UHumanAnimInstance::UpdateTransitions(float DeltaTime)
 {
 	// Because the allowed transition curve changes within certain states, the allowed transitions are true in those states.
 
 	TransitionsState.bTransitionsAllowed = FAnimWeight::IsFullWeight(GetCurveValue(ULocomotionGeneralNameStatics::AllowTransitionsCurveName()));
 
-	UpdateDynamicTransition();
+	UpdateDynamicTransition(DeltaTime);
 }
 
-void UHumanAnimInstance::UpdateDynamicTransition()
+void UHumanAnimInstance::UpdateDynamicTransition(float DeltaTime)
 {
-	if (TransitionsState.DynamicTransitionsFrameDelay > 0)
+	if (TransitionsState.DynamicTransitionsDelayTime > 0.0f)
 	{
-		TransitionsState.DynamicTransitionsFrameDelay -= 1;
+		TransitionsState.DynamicTransitionsDelayTime -= DeltaTime;
 		return;
 	}
 
-	if (!TransitionsState.bTransitionsAllowed || LocomotionState.bMoving || LocomotionMode != TAG_Status_LocomotionMode_OnGround)
+	if (!IsDynamicTransitionAllowed() || !TransitionsState.bTransitionsAllowed || LocomotionState.bMoving || LocomotionMode != TAG_Status_LocomotionMode_OnGround)
 	{
 		return;
 	}
@@ -1084,44 +1928,37 @@ void UHumanAnimInstance::UpdateDynamicTransition()
 		return;
 	}
 
+	// Animations that have not streamed in yet are null, in which case the transition is skipped.
+
+	const auto& TransitionAnimations{ GetTransitionAnimations() };
+
 	TObjectPtr<UAnimSequenceBase> DynamicTransitionAnimation;
+	FVector::FReal FootLockDistanceSquared;
 
 	// If both transitions are allowed, select the one with the greater locking distance.
 
-	if (!bTransitionLeftAllowed)
-	{
-		DynamicTransitionAnimation = Stance == TAG_Status_Stance_Crouching
-			? CrouchingDynamicTransitionRightAnimation
-			: StandingDynamicTransitionRightAnimation;
-	}
-	else if (!bTransitionRightAllowed)
-	{
-		DynamicTransitionAnimation = Stance == TAG_Status_Stance_Crouching
-			? CrouchingDynamicTransitionLeftAnimation
-			: StandingDynamicTransitionLeftAnimation;
-	}
-	else if (FootLockLeftDistanceSquared >= FootLockRightDistanceSquared)
+	if (!bTransitionLeftAllowed || (bTransitionRightAllowed && (FootLockRightDistanceSquared > FootLockLeftDistanceSquared)))
 	{
-		DynamicTransitionAnimation = Stance == TAG_Status_Stance_Crouching
-			? CrouchingDynamicTransitionLeftAnimation
-			: StandingDynamicTransitionLeftAnimation;
+		DynamicTransitionAnimation = TransitionAnimations.DynamicTransitionRightAnimation;
+		FootLockDistanceSquared = FootLockRightDistanceSquared;
 	}
 	else
 	{
-		DynamicTransitionAnimation = Stance == TAG_Status_Stance_Crouching
-			? CrouchingDynamicTransitionRightAnimation
-			: StandingDynamicTransitionRightAnimation;
+		DynamicTransitionAnimation = TransitionAnimations.DynamicTransitionLeftAnimation;
+		FootLockDistanceSquared = FootLockLeftDistanceSquared;
 	}
 
 	if (IsValid(DynamicTransitionAnimation))
 	{
-		// Block the next dynamic transition by approximately two frames to give the animation blueprint time to react properly to the animation.
+		// Block the next dynamic transition for a while to give the animation blueprint time to react properly to the animation.
+		// It is measured in time rather than frames so that it lasts equally long when updates are skipped.
 
-		TransitionsState.DynamicTransitionsFrameDelay = 2;
+		TransitionsState.DynamicTransitionsDelayTime = DynamicTransitionDelayTime;
 
 		// Animated montages cannot be played in the worker thread, so they are queued and played later in the game thread.
 
 		TransitionsState.QueuedDynamicTransitionAnimation = DynamicTransitionAnimation;
+		TransitionsState.QueuedDynamicTransitionDistance = UE_REAL_TO_FLOAT(FMath::Sqrt(FootLockDistanceSquared)) / LocomotionState.Scale;
 
 		if (IsInGameThread())
 		{
@@ -1134,20 +1971,148 @@ void UHumanAnimInstance::PlayQueuedDynamicTransitionAnimation()
 {
 	check(IsInGameThread());
 
-	PlaySlotAnimationAsDynamicMontage(TransitionsState.QueuedDynamicTransitionAnimation, ULocomotionHumanNameStatics::TransitionSlotName(),
+	if (!TransitionsState.QueuedDynamicTransitionAnimation)
+	{
+		return;
+	}
+
+	// Start where the remaining travel of the stepping foot matches the distance from the locked foot to its target
+
+	const auto* CurveSummary{ bUseDistanceMatching ? FindDistanceCurveSummary(TransitionsState.QueuedDynamicTransitionAnimation) : nullptr };
+	const auto StartTime{ CurveSummary ? CurveSummary->GetDistanceLookupTable().GetTimeAtDistance(TransitionsState.QueuedDynamicTransitionDistance) : 0.0f };
+
+	PlayPooledTransitionMontage(TransitionsState.QueuedDynamicTransitionAnimation,
 		DynamicTransitionBlendDuration,
 		DynamicTransitionBlendDuration,
-		DynamicTransitionPlayRate, 1, 0.0f);
+		DynamicTransitionPlayRate, StartTime);
 
 	TransitionsState.QueuedDynamicTransitionAnimation = nullptr;
 }
 
-#pragma endregion
+bool UHumanAnimInstance::PlayDistanceMatchedTransitionAnimation(UAnimSequenceBase* Animation, float BlendInDuration, float BlendOutDuration)
+{
+	check(IsInGameThread());
 
+	const auto* CurveSummary{ FindDistanceCurveSummary(Animation) };
 
-#pragma region Rotate In Place
+	if (!CurveSummary || !IsValid(CharacterMovement) || !IsCosmeticUpdateAllowed())
+	{
+		return false;
+	}
 
-void UHumanAnimInstance::UpdateRotateInPlace(float DeltaTime)
+	const auto StartTime{ CurveSummary->GetDistanceLookupTable().GetTimeAtDistance(PredictStopDistance()) };
+
+	auto* Montage{ PlayPooledTransitionMontage(Animation, BlendInDuration, BlendOutDuration, 1.0f, StartTime) };
+
+	if (!Montage)
+	{
+		return false;
+	}
+
+	// Started at the minimum rate, and UpdateDistanceMatchingOnGameThread() drives it by the distance traveled from the next update
+
+	Montage_SetPlayRate(Montage, DistanceMatchingMinPlayRate);
+
+	TransitionsState.DistanceMatchedMontage = Montage;
+	TransitionsState.DistanceMatchedCurveSummary = CurveSummary;
+
+	return true;
+}
+
+void UHumanAnimInstance::UpdateDistanceMatchingOnGameThread(float DeltaTime)
+{
+	auto* Montage{ TransitionsState.DistanceMatchedMontage.Get() };
+
+	if (!Montage)
+	{
+		return;
+	}
+
+	const auto* CurveSummary{ TransitionsState.DistanceMatchedCurveSummary.Get() };
+
+	if (!IsValid(CurveSummary) || !Montage_IsActive(Montage) || Montage_GetIsStopped(Montage))
+	{
+		TransitionsState.DistanceMatchedMontage = nullptr;
+		TransitionsState.DistanceMatchedCurveSummary = nullptr;
+		return;
+	}
+
+	// The character no longer stops once the input is back, so the quick stop blends out instead of waiting for the stop
+
+	if (LocomotionState.bHasInput)
+	{
+		Montage_Stop(QuickStopBlendOutDuration, Montage);
+
+		TransitionsState.DistanceMatchedMontage = nullptr;
+		TransitionsState.DistanceMatchedCurveSummary = nullptr;
+		return;
+	}
+
+	const auto& LookupTable{ CurveSummary->GetDistanceLookupTable() };
+	const auto Position{ Montage_GetPosition(Montage) };
+
+	// Once the marker is reached, the rest of the animation settles at the normal rate
+
+	if (Position >= LookupTable.MarkerTime - UE_KINDA_SMALL_NUMBER)
+	{
+		Montage_SetPlayRate(Montage, 1.0f);
+
+		TransitionsState.DistanceMatchedMontage = nullptr;
+		TransitionsState.DistanceMatchedCurveSummary = nullptr;
+		return;
+	}
+
+	// The montage is advanced by its play rate instead of setting its position, so that the notifies and branching points are not skipped.
+	// The rate is chosen to reach the position of the predicted stop distance over the next update, which lags it by one frame.
+	// The position keeps moving forward at least at the minimum rate so that the montage never stays paused when the predicted stop distance
+	// stops shrinking (e.g. without braking), and not faster than the maximum quick stop play rate so that a sudden stop does not skip the animation
+
+	const auto TargetPosition{ LookupTable.GetTimeAtDistance(PredictStopDistance()) };
+	const auto PlayRate{ (DeltaTime > UE_SMALL_NUMBER) ? (TargetPosition - Position) / DeltaTime : 0.0f };
+	const auto MaxPlayRate{ FMath::Max(QuickStopPlayRate.Y, DistanceMatchingMinPlayRate) };
+
+	Montage_SetPlayRate(Montage, FMath::Clamp(PlayRate, DistanceMatchingMinPlayRate, MaxPlayRate));
+}
+
+float UHumanAnimInstance::PredictStopDistance() const
+{
+	if (!IsValid(CharacterMovement))
+	{
+		return 0.0f;
+	}
+
+	const auto StopOffset
+	{
+		UAnimCharacterMovementLibrary::PredictGroundMovementStopLocation(
+			CharacterMovement->Velocity,
+			CharacterMovement->bUseSeparateBrakingFriction,
+			CharacterMovement->BrakingFriction,
+			CharacterMovement->GroundFriction,
+			CharacterMovement->BrakingFrictionFactor,
+			CharacterMovement->GetMaxBrakingDeceleration())
+	};
+
+	return UE_REAL_TO_FLOAT(StopOffset.Size2D()) / LocomotionState.Scale;
+}
+
+const UHumanCurveSummaryUserData* UHumanAnimInstance::FindDistanceCurveSummary(const UAnimSequenceBase* Animation)
+{
+	if (!IsValid(Animation))
+	{
+		return nullptr;
+	}
+
+	const auto* CurveSummary{ const_cast<UAnimSequenceBase*>(Animation)->GetAssetUserData<UHumanCurveSummaryUserData>() };
+
+	return (CurveSummary && CurveSummary->GetDistanceLookupTable().IsValid()) ? CurveSummary : nullptr;
+}
+
+#pragma endregion
+
+
+#pragma region Rotate In Place
+
+void UHumanAnimInstance::UpdateRotateInPlace(float DeltaTime)
 {
 	static constexpr auto PlayRateInterpolationSpeed{ 5.0f };
 
@@ -1160,7 +2125,7 @@ void UHumanAnimInstance::UpdateRotateInPlace(float DeltaTime)
 
 		RotateInPlaceState.PlayRate = bPendingUpdate
 			? RotationInPlacePlayRate.X
-			: FMath::FInterpTo(RotateInPlaceState.PlayRate, RotationInPlacePlayRate.X,
+			: ULocomotionFunctionLibrary::ExponentialDecay(RotateInPlaceState.PlayRate, RotationInPlacePlayRate.X,
 				DeltaTime, PlayRateInterpolationSpeed);
 
 		RotateInPlaceState.FootLockBlockAmount = 0.0f;
@@ -1176,7 +2141,7 @@ void UHumanAnimInstance::UpdateRotateInPlace(float DeltaTime)
 	{
 		RotateInPlaceState.PlayRate = bPendingUpdate
 			? RotationInPlacePlayRate.X
-			: FMath::FInterpTo(RotateInPlaceState.PlayRate, RotationInPlacePlayRate.X,
+			: ULocomotionFunctionLibrary::ExponentialDecay(RotateInPlaceState.PlayRate, RotationInPlacePlayRate.X,
 				DeltaTime, PlayRateInterpolationSpeed);
 
 		RotateInPlaceState.FootLockBlockAmount = 0.0f;
@@ -1189,7 +2154,7 @@ void UHumanAnimInstance::UpdateRotateInPlace(float DeltaTime)
 
 	RotateInPlaceState.PlayRate = bPendingUpdate
 		? PlayRate
-		: FMath::FInterpTo(RotateInPlaceState.PlayRate, PlayRate,
+		: ULocomotionFunctionLibrary::ExponentialDecay(RotateInPlaceState.PlayRate, PlayRate,
 			DeltaTime, PlayRateInterpolationSpeed);
 
 	// Disable the foot lock when rotating at large angles or rotating too fast. Otherwise, the legs may twist spirally.
@@ -1205,7 +2170,7 @@ void UHumanAnimInstance::UpdateRotateInPlace(float DeltaTime)
 		? 0.0f
 		: bPendingUpdate
 		? 1.0f
-		: FMath::FInterpTo(RotateInPlaceState.FootLockBlockAmount, 1.0f, DeltaTime, BlockInterpolationSpeed);
+		: ULocomotionFunctionLibrary::ExponentialDecay(RotateInPlaceState.FootLockBlockAmount, 1.0f, DeltaTime, BlockInterpolationSpeed);
 }
 
 bool UHumanAnimInstance::IsRotateInPlaceAllowed()
@@ -1218,7 +2183,22 @@ bool UHumanAnimInstance::IsRotateInPlaceAllowed()
 
 #pragma region Control Rig Input
 
-FControlRigInput UHumanAnimInstance::GetControlRigInput() const
+const FControlRigInput& UHumanAnimInstance::GetControlRigInput() const
+{
+	if (ControlRigInputBuiltFrame == GFrameCounter)
+	{
+		INC_DWORD_STAT(STAT_HumanAnimInstance_RedundantControlRigInputs);
+		return CachedControlRigInput;
+	}
+
+	ControlRigInputBuiltFrame = GFrameCounter;
+
+	CachedControlRigInput = BuildControlRigInput();
+
+	return CachedControlRigInput;
+}
+
+FControlRigInput UHumanAnimInstance::BuildControlRigInput() const
 {
 	return {
 		bUseHandIkBones,
@@ -1237,3 +2217,524 @@ FControlRigInput UHumanAnimInstance::GetControlRigInput() const
 }
 
 #pragma endregion
+
+
+#pragma region Animation Sharing
+
+EHumanAnimationSharingState UHumanAnimInstance::ComputeAnimationSharingState() const
+{
+	if (!IsValid(Character) || !IsValid(CharacterMovement))
+	{
+		return EHumanAnimationSharingState::StandingIdle;
+	}
+
+	if (!CharacterMovement->IsMovingOnGround())
+	{
+		return EHumanAnimationSharingState::InAir;
+	}
+
+	const auto bCrouching{ CharacterMovement->GetStance() == TAG_Status_Stance_Crouching };
+
+	using EState = EHumanAnimationSharingState;
+
+	const auto IdleState{ bCrouching ? EState::CrouchingIdle : EState::StandingIdle };
+
+	const auto Velocity{ Character->GetVelocity() };
+	const auto Speed{ UE_REAL_TO_FLOAT(Velocity.Size2D()) };
+
+	if (Speed < SharingIdleSpeedThreshold)
+	{
+		// Same condition as UpdateRotateInPlace(), but with the view yaw angle taken from the character.
+
+		const auto bRotateInPlaceAllowed{ CharacterMovement->GetRotationMode() != TAG_Status_RotationMode_VelocityDirection };
+		const auto ViewYawAngle{ FRotator3f::NormalizeAxis(UE_REAL_TO_FLOAT(Character->GetBaseAimRotation().Yaw - Character->GetActorRotation().Yaw)) };
+
+		const auto Offset
+		{
+			!bRotateInPlaceAllowed ? 0 : (ViewYawAngle < -ViewYawAngleThreshold) ? 1 : (ViewYawAngle > ViewYawAngleThreshold) ? 2 : 0
+		};
+
+		return static_cast<EState>(static_cast<uint8>(IdleState) + Offset);
+	}
+
+	// Gait is bucketed by the animated speeds so that it does not depend on the gait updated by this AnimInstance.
+
+	const auto WalkRunThreshold{ (GetAnimatedWalkSpeed() + GetAnimatedRunSpeed()) * 0.5f };
+	const auto RunSprintThreshold{ (GetAnimatedRunSpeed() + GetAnimatedSprintSpeed()) * 0.5f };
+
+	if (!bCrouching && Speed > RunSprintThreshold)
+	{
+		return EState::StandingSprint;
+	}
+
+	static constexpr auto ForwardHalfAngle{ 70.0f };
+
+	const auto Direction
+	{
+		UHumanLocomotionFunctionLibrary::CalculateMovementDirection(
+			FRotator3f::NormalizeAxis(UE_REAL_TO_FLOAT(Velocity.Rotation().Yaw - Character->GetBaseAimRotation().Yaw)),
+			ForwardHalfAngle, 5.0f)
+	};
+
+	// Walk and run states are laid out in the order of EMovementDirection after the rotate in place states.
+
+	const auto bRunning{ !bCrouching && Speed > WalkRunThreshold };
+	const auto Offset{ 3 + (bRunning ? 4 : 0) + static_cast<uint8>(Direction) };
+
+	return static_cast<EState>(static_cast<uint8>(IdleState) + Offset);
+}
+
+#pragma endregion
+
+
+#pragma region Linked Layer Pool
+
+void UHumanAnimInstance::PrewarmLinkedLayerPool()
+{
+	for (const auto& LinkedLayerClass : PooledLinkedLayerClasses)
+	{
+		FindOrCreatePooledLinkedLayer(LinkedLayerClass);
+	}
+}
+
+UHumanLinkedAnimInstance* UHumanAnimInstance::FindOrCreatePooledLinkedLayer(TSubclassOf<UHumanLinkedAnimInstance> InClass)
+{
+	if (!InClass)
+	{
+		return nullptr;
+	}
+
+	if (const auto* PooledInstance{ LinkedLayerPool.Find(InClass) })
+	{
+		return *PooledInstance;
+	}
+
+	auto* MeshComponent{ GetSkelMeshComponent() };
+
+	if (!IsValid(MeshComponent))
+	{
+		return nullptr;
+	}
+
+	// Instantiate and initialize it in the same way as LinkAnimClassLayers() so that only the rebinding remains at the time of swap.
+
+	auto* NewInstance{ NewObject<UHumanLinkedAnimInstance>(MeshComponent, InClass) };
+	NewInstance->Parent = this;
+	NewInstance->InitializeAnimation();
+
+	LinkedLayerPool.Add(InClass, NewInstance);
+
+	return NewInstance;
+}
+
+void UHumanAnimInstance::DestroyLinkedLayerPool()
+{
+	auto* MeshComponent{ GetSkelMeshComponent() };
+
+	for (const auto& KVP : LinkedLayerPool)
+	{
+		if (!IsValid(KVP.Value))
+		{
+			continue;
+		}
+
+		if (IsValid(MeshComponent))
+		{
+			MeshComponent->GetLinkedAnimInstances().Remove(KVP.Value);
+		}
+
+		KVP.Value->UninitializeAnimation();
+	}
+
+	LinkedLayerPool.Reset();
+}
+
+void UHumanAnimInstance::LinkPooledAnimClassLayers(TSubclassOf<UHumanLinkedAnimInstance> InClass)
+{
+	auto* PooledInstance{ FindOrCreatePooledLinkedLayer(InClass) };
+
+	if (!PooledInstance)
+	{
+		LinkAnimClassLayers(InClass);
+		return;
+	}
+
+	const auto* AnimClassInterface{ IAnimClassInterface::GetFromClass(GetClass()) };
+
+	if (!AnimClassInterface)
+	{
+		return;
+	}
+
+	for (const auto* LayerNodeProperty : AnimClassInterface->GetLinkedAnimLayerNodeProperties())
+	{
+		auto* LayerNode{ LayerNodeProperty->ContainerPtrToValuePtr<FAnimNode_LinkedAnimLayer>(this) };
+
+		if (!LayerNode->Interface.Get() || !InClass->ImplementsInterface(LayerNode->Interface.Get()))
+		{
+			continue;
+		}
+
+		if (!InClass->FindFunctionByName(LayerNode->Layer) || (LayerNode->GetTargetInstance<UAnimInstance>() == PooledInstance))
+		{
+			continue;
+		}
+
+		LayerNode->SetLinkedLayerInstance(this, PooledInstance);
+	}
+
+	// Register it with the mesh in the same way as LinkAnimClassLayers() so that the mesh ticks it and dispatches its notifies.
+
+	GetSkelMeshComponent()->GetLinkedAnimInstances().AddUnique(PooledInstance);
+}
+
+void UHumanAnimInstance::UnlinkPooledAnimClassLayers(TSubclassOf<UHumanLinkedAnimInstance> InClass)
+{
+	auto* PooledInstance{ InClass ? LinkedLayerPool.FindRef(InClass).Get() : nullptr };
+	const auto* AnimClassInterface{ IAnimClassInterface::GetFromClass(GetClass()) };
+
+	if (!PooledInstance || !AnimClassInterface)
+	{
+		return;
+	}
+
+	for (const auto* LayerNodeProperty : AnimClassInterface->GetLinkedAnimLayerNodeProperties())
+	{
+		auto* LayerNode{ LayerNodeProperty->ContainerPtrToValuePtr<FAnimNode_LinkedAnimLayer>(this) };
+
+		if (LayerNode->GetTargetInstance<UAnimInstance>() == PooledInstance)
+		{
+			LayerNode->SetLinkedLayerInstance(this, nullptr);
+		}
+	}
+
+	GetSkelMeshComponent()->GetLinkedAnimInstances().Remove(PooledInstance);
+}
+
+#pragma endregion
+
+
+#pragma region Linked Layer Snapshot
+
+void UHumanAnimInstance::PublishLinkedLayerSnapshot()
+{
+	auto& Snapshot{ LinkedLayerSnapshotBuffer->GetBackSlot() };
+
+	Snapshot.PoseState = PoseState;
+	Snapshot.LayeringState = LayeringState;
+	Snapshot.OnGroundState = OnGroundState;
+
+	Snapshot.FeetSummary.FootPlantedAmount = FeetState.FootPlantedAmount;
+	Snapshot.FeetSummary.FeetCrossingAmount = FeetState.FeetCrossingAmount;
+	Snapshot.FeetSummary.FootLeftIkAmount = FeetState.Left.IkAmount;
+	Snapshot.FeetSummary.FootLeftLockAmount = FeetState.Left.LockAmount;
+	Snapshot.FeetSummary.FootRightIkAmount = FeetState.Right.IkAmount;
+	Snapshot.FeetSummary.FootRightLockAmount = FeetState.Right.LockAmount;
+	Snapshot.FeetSummary.MinMaxPelvisOffsetZ = FeetState.MinMaxPelvisOffsetZ;
+
+	LinkedLayerSnapshotBuffer->Publish();
+}
+
+#pragma endregion
+
+
+#pragma region Prewarm
+
+UAnimMontage* UHumanAnimInstance::PlayPooledTransitionMontage(UAnimSequenceBase* Animation, float BlendInDuration, float BlendOutDuration, float PlayRate, float StartTime)
+{
+	if (!IsValid(Animation))
+	{
+		return nullptr;
+	}
+
+	// A new transition replaces the distance matched one
+
+	TransitionsState.DistanceMatchedMontage = nullptr;
+	TransitionsState.DistanceMatchedCurveSummary = nullptr;
+
+	auto* Subsystem{ UHumanAnimationSubsystem::Get(GetWorld()) };
+	auto* Montage{ Subsystem ? Subsystem->FindOrCreateSlotMontage(Animation, ULocomotionHumanNameStatics::TransitionSlotName(), BlendInDuration, BlendOutDuration) : nullptr };
+
+	if (!Montage)
+	{
+		return PlaySlotAnimationAsDynamicMontage(Animation, ULocomotionHumanNameStatics::TransitionSlotName(), BlendInDuration, BlendOutDuration, PlayRate, 1, 0.0f, StartTime);
+	}
+
+	// Montage_Play() blends out the active montages of the same group, including a previous instance of the pooled montage
+
+	return (Montage_Play(Montage, PlayRate, EMontagePlayReturnType::MontageLength, StartTime) > 0.0f) ? Montage : nullptr;
+}
+
+void UHumanAnimInstance::Prewarm(UHumanAnimationSubsystem& Subsystem) const
+{
+	// UCurveFloat has no bake step, so evaluating each curve once only makes sure that the rich curve keys are resident
+
+	const UCurveFloat* Curves[]
+	{
+		StrideBlendAmountWalkCurve,
+		StrideBlendAmountRunCurve,
+		RotationYawOffsetForwardCurve,
+		RotationYawOffsetBackwardCurve,
+		RotationYawOffsetLeftCurve,
+		RotationYawOffsetRightCurve,
+		LeanAmountCurve,
+		GroundPredictionAmountCurve
+	};
+
+	for (const auto* Curve : Curves)
+	{
+		if (Curve)
+		{
+			Curve->GetFloatValue(0.0f);
+		}
+	}
+
+	// Create the montages with the blend settings used by the default transition paths.
+	// Only the animations that are already loaded are pooled, so that prewarming does not defeat their streaming.
+
+	const auto TransitionSlotName{ ULocomotionHumanNameStatics::TransitionSlotName() };
+
+	for (auto* Animation : { StandingTransitionLeftAnimation.Get(), StandingTransitionRightAnimation.Get(),
+							 CrouchingTransitionLeftAnimation.Get(), CrouchingTransitionRightAnimation.Get() })
+	{
+		Subsystem.FindOrCreateSlotMontage(Animation, TransitionSlotName, 0.2f, 0.2f);
+		Subsystem.FindOrCreateSlotMontage(Animation, TransitionSlotName, QuickStopBlendInDuration, QuickStopBlendOutDuration);
+	}
+
+	for (auto* Animation : { StandingDynamicTransitionLeftAnimation.Get(), StandingDynamicTransitionRightAnimation.Get(),
+							 CrouchingDynamicTransitionLeftAnimation.Get(), CrouchingDynamicTransitionRightAnimation.Get() })
+	{
+		Subsystem.FindOrCreateSlotMontage(Animation, TransitionSlotName, DynamicTransitionBlendDuration, DynamicTransitionBlendDuration);
+	}
+}
+
+#pragma endregion
+
+
+#pragma region Curve Read Elision
+
+void UHumanAnimInstance::UpdateCurveReadElisionOnGameThread(float DeltaTime)
+{
+	bLayeringCurvesElided = false;
+	bPoseCurvesElided = false;
+
+	if (!bElideConstantCurveReads)
+	{
+		return;
+	}
+
+	// Only the asset pointers of the tick records are gathered every update, which is as cheap as the tick records themselves
+
+	TArray<const UAnimationAsset*, TInlineAllocator<16>> Assets;
+	TArray<const UClass*, TInlineAllocator<4>> Classes;
+
+	if (!GatherCurveSourceAssets(Assets, Classes))
+	{
+		bCurveSourceAssetsValid = false;
+		return;
+	}
+
+	// The anim classes are scanned, the blend spaces are expanded and the summaries are merged only when the assets or the linked layers change,
+	// and the curves are read as usual until the blends have settled
+
+	if (!bCurveSourceAssetsValid || (Assets != CurveSourceAssets) || (Classes != CurveSourceClasses))
+	{
+		CurveSourceAssets = MoveTemp(Assets);
+		CurveSourceClasses = MoveTemp(Classes);
+		bCurveSourceAssetsValid = true;
+		CurveSourcesStableTime = 0.0f;
+
+		TArray<const UAnimSequenceBase*, TInlineAllocator<16>> Sources;
+
+		// Without any source the curves come entirely from nodes without a tick record, so nothing is known about them
+
+		const auto bExpanded
+		{
+			!CurveSourceClasses.ContainsByPredicate(&UHumanAnimInstance::HasUntrackedCurveNodes) &&
+			ExpandCurveSources(CurveSourceAssets, Sources) &&
+			!Sources.IsEmpty()
+		};
+
+		bLayeringCurvesConstant = bExpanded && AreCurvesConstant(Sources, GetLayeringCurveNames());
+		bPoseCurvesConstant = bExpanded && AreCurvesConstant(Sources, GetPoseCurveNames());
+		return;
+	}
+
+	if (CurveSourcesStableTime < CurveReadElisionSettleTime)
+	{
+		CurveSourcesStableTime += DeltaTime;
+		return;
+	}
+
+	bLayeringCurvesElided = bLayeringCurvesConstant;
+	bPoseCurvesElided = bPoseCurvesConstant;
+}
+
+bool UHumanAnimInstance::GatherCurveSourceAssets(TArray<const UAnimationAsset*, TInlineAllocator<16>>& OutAssets, TArray<const UClass*, TInlineAllocator<4>>& OutClasses) const
+{
+	const auto AddAssets
+	{
+		[&OutAssets, &OutClasses](const UAnimInstance* Instance)
+		{
+			// Curves of the montages come from their segments, which are not in the tick records
+
+			if (Instance->MontageInstances.Num() > 0)
+			{
+				return false;
+			}
+
+			OutClasses.Add(Instance->GetClass());
+
+			const auto& Proxy{ Instance->GetProxyOnGameThread<FAnimInstanceProxy>() };
+
+			for (const auto& KVP : Proxy.GetSyncGroupMapRead())
+			{
+				for (const auto& TickRecord : KVP.Value.ActivePlayers)
+				{
+					OutAssets.Add(TickRecord.SourceAsset);
+				}
+			}
+
+			for (const auto& TickRecord : Proxy.GetUngroupedActivePlayersRead())
+			{
+				OutAssets.Add(TickRecord.SourceAsset);
+			}
+
+			return true;
+		}
+	};
+
+	if (!AddAssets(this))
+	{
+		return false;
+	}
+
+	for (const auto* LinkedInstance : GetSkelMeshComponent()->GetLinkedAnimInstances())
+	{
+		if (LinkedInstance && !AddAssets(LinkedInstance))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool UHumanAnimInstance::HasUntrackedCurveNodes(const UClass* AnimClass)
+{
+	const auto* AnimClassInterface{ IAnimClassInterface::GetFromClass(const_cast<UClass*>(AnimClass)) };
+
+	if (!AnimClassInterface)
+	{
+		return false;
+	}
+
+	// Control Rig is found by name, since this module does not depend on its plugin
+
+	static const FName ControlRigNodeName{ TEXT("AnimNode_ControlRigBase") };
+
+	const UScriptStruct* UntrackedNodes[]
+	{
+		FAnimNode_SequenceEvaluator::StaticStruct(),
+		FAnimNode_PoseHandler::StaticStruct(),
+		FAnimNode_ModifyCurve::StaticStruct(),
+		FAnimNode_HumanCycleLocomotion::StaticStruct(),
+	};
+
+	for (const auto* NodeProperty : AnimClassInterface->GetAnimNodeProperties())
+	{
+		for (const UStruct* Struct{ NodeProperty->Struct }; Struct; Struct = Struct->GetSuperStruct())
+		{
+			if ((Struct->GetFName() == ControlRigNodeName) || Algo::Find(UntrackedNodes, Struct))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool UHumanAnimInstance::ExpandCurveSources(TConstArrayView<const UAnimationAsset*> Assets, TArray<const UAnimSequenceBase*, TInlineAllocator<16>>& OutSources)
+{
+	for (const auto* Asset : Assets)
+	{
+		if (const auto* Sequence{ Cast<UAnimSequence>(Asset) })
+		{
+			OutSources.Add(Sequence);
+		}
+		else if (const auto* BlendSpace{ Cast<UBlendSpace>(Asset) })
+		{
+			for (const auto& Sample : BlendSpace->GetBlendSamples())
+			{
+				if (Sample.Animation)
+				{
+					OutSources.Add(Sample.Animation);
+				}
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// Remove the duplicates once, instead of searching the array for every sample
+
+	OutSources.Sort();
+
+	OutSources.SetNum(Algo::Unique(OutSources));
+
+	return true;
+}
+
+bool UHumanAnimInstance::AreCurvesConstant(TConstArrayView<const UAnimSequenceBase*> Sources, TConstArrayView<FName> CurveNames)
+{
+	// Sequences without the summary may have any curve
+
+	TArray<const UHumanCurveSummaryUserData*, TInlineAllocator<16>> Summaries;
+
+	for (const auto* Source : Sources)
+	{
+		const auto* Summary{ const_cast<UAnimSequenceBase*>(Source)->GetAssetUserData<UHumanCurveSummaryUserData>() };
+
+		if (!Summary)
+		{
+			return false;
+		}
+
+		Summaries.Add(Summary);
+	}
+
+	// A curve that is absent from all sources is 0, and otherwise the weights of the blend sum to 1, so the value does not change when every source agrees
+
+	for (const auto& CurveName : CurveNames)
+	{
+		auto ExpectedValue{ 0.0f };
+		auto bFirst{ true };
+
+		for (const auto* Summary : Summaries)
+		{
+			auto Value{ 0.0f };
+
+			if (!Summary->GetConstantValue(CurveName, Value))
+			{
+				return false;
+			}
+
+			if (bFirst)
+			{
+				ExpectedValue = Value;
+				bFirst = false;
+			}
+			else if (!FMath::IsNearlyEqual(Value, ExpectedValue))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+#pragma endregion
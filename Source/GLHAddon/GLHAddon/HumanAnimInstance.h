@@ -13,13 +13,29 @@
 #include "State/InAirState.h"
 #include "State/InWaterState.h"
 #include "State/FeetState.h"
+#include "State/FootstepState.h"
 #include "State/TransitionsState.h"
 #include "State/RotateInPlaceState.h"
 #include "State/ControlRigInput.h"
+#include "State/SleepState.h"
+#include "Type/AnimQualityTypes.h"
+#include "Type/HumanAnimationSharingTypes.h"
+#include "State/LinkedLayerSnapshot.h"
 
 #include "HumanAnimInstance.generated.h"
 
 class UHumanLinkedAnimInstance;
+struct FHumanAnimInstanceProxy;
+class USkeletalMeshComponentBudgeted;
+struct FHumanMeshBoneCache;
+class UHumanAnimationSubsystem;
+class UHumanLocomotionSpeedSettings;
+class UAnimSequenceBase;
+class UAnimMontage;
+class UHumanCurveSummaryUserData;
+class UHumanFootstepEffectSettings;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FHumanFootstepsDelegate, const TArray<FHumanFootstepEvent>&, Footsteps);
 
 
 /**
@@ -34,6 +50,7 @@ class GLHADDON_API UHumanAnimInstance : public UCharacterAnimInstance
 	GENERATED_BODY()
 
 	friend UHumanLinkedAnimInstance;
+	friend FHumanAnimInstanceProxy;
 
 public:
 	UHumanAnimInstance(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
@@ -41,6 +58,19 @@ public:
 protected:
 	virtual FAnimInstanceProxy* CreateAnimInstanceProxy() override;
 
+public:
+	/**
+	 * Returns the UHumanAnimInstance that holds the state for the AnimInstance that owns the proxy.
+	 * 
+	 * Tips:
+	 *	If the owner is UHumanLinkedAnimInstance, its Parent is returned.
+	 */
+	static UHumanAnimInstance* GetHumanAnimInstance(const FAnimInstanceProxy* InProxy);
+
+
+public:
+	virtual void NativeBeginPlay() override;
+	virtual void NativeUninitializeAnimation() override;
 
 protected:
 	virtual void UpdateAnimationOnGameThread(float DeltaTime) override;
@@ -48,6 +78,156 @@ protected:
 	virtual void OnPostEvaluateAnimation() override;
 
 
+	/////////////////////////////////////////
+	// Sleep State
+#pragma region Sleep State
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
+	FSleepState SleepState;
+
+	//
+	// Whether to skip the thread safe update while the character, view, curves and feet stay still
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Sleep")
+	bool bAllowSleep{ false };
+
+	//
+	// Number of consecutive quiescent frames required before going to sleep
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Sleep", Meta = (ClampMin = 1, EditCondition = "bAllowSleep"))
+	int32 SleepQuiescentFrameCount{ 30 };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Sleep", Meta = (ClampMin = 0, EditCondition = "bAllowSleep", ForceUnits = "cm"))
+	float SleepLocationTolerance{ 0.1f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Sleep", Meta = (ClampMin = 0, EditCondition = "bAllowSleep", ForceUnits = "deg"))
+	float SleepViewRotationTolerance{ 0.1f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Sleep", Meta = (ClampMin = 0, EditCondition = "bAllowSleep"))
+	float SleepCurveTolerance{ 0.001f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Sleep", Meta = (ClampMin = 0, EditCondition = "bAllowSleep", ForceUnits = "cm/s"))
+	float SleepFootSpringSpeedTolerance{ 0.1f };
+
+protected:
+	void UpdateSleepOnGameThread();
+
+	/**
+	 * Returns true if the thread safe update of this frame can be skipped
+	 */
+	bool UpdateSleep();
+
+	bool IsQuiescent() const;
+
+	bool AreCurvesQuiescent() const;
+
+	void CaptureReferenceCurveValues();
+
+public:
+	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance")
+	void WakeUp();
+
+	bool IsSleeping() const { return SleepState.bSleeping; }
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Quality Tier
+#pragma region Quality Tier
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
+	EHumanAnimQualityTier QualityTier{ EHumanAnimQualityTier::High };
+
+	//
+	// Whether to add the measured worker thread update time of this AnimInstance to the tick time
+	// that the budgeted component reports to the animation budget allocator
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Quality")
+	bool bReportMeasuredBudgetCost{ true };
+
+	//
+	// Number of updates between feet traces in the medium tier. The traces of the other updates are reused.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Quality", Meta = (ClampMin = 1))
+	int32 MediumQualityFeetTraceInterval{ 2 };
+
+	//
+	// Number of updates between feet traces in the low tier. The traces of the other updates are reused.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Quality", Meta = (ClampMin = 1))
+	int32 LowQualityFeetTraceInterval{ 4 };
+
+	//
+	// Number of frames between look updates in the low tier
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Quality", Meta = (ClampMin = 1))
+	int32 LowQualityLookUpdateInterval{ 2 };
+
+	//
+	// Whether to use the ServerLean tier on dedicated servers regardless of the animation budget
+	// 
+	// Tips:
+	//	The layering and feet states are reset in this tier, so the server pose no longer matches the clients (e.g. for hitboxes).
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configs|Quality")
+	bool bServerLeanOnDedicatedServer{ false };
+
+	//
+	// Whether to use the ServerLean tier on listen servers regardless of the animation budget.
+	// The local characters of the host are also affected.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configs|Quality")
+	bool bServerLeanOnListenServer{ false };
+
+	bool bBudgetReduceWork{ false };
+
+	int32 FeetTraceCounter{ 0 };
+
+	bool bTraceFeetThisUpdate{ true };
+
+	//
+	// Time spent in the worker thread update of this AnimInstance in the current frame
+	//
+	uint64 MeasuredUpdateCycles{ 0 };
+
+protected:
+	/**
+	 * Bind to the reduce work delegate of the budgeted component
+	 * 
+	 * Tips:
+	 *	The delegate is single-cast, so it is left untouched if something else has already bound it.
+	 */
+	void BindToBudgetedComponent();
+
+	void UnbindFromBudgetedComponent();
+
+	void HandleReduceWork(USkeletalMeshComponentBudgeted* InComponent, bool bReduceWork);
+
+	void UpdateQualityTierOnGameThread();
+
+	void ReportMeasuredBudgetCost();
+
+	void ResetServerLeanStates();
+
+public:
+	EHumanAnimQualityTier GetQualityTier() const { return QualityTier; }
+
+	bool IsGroundPredictionAllowed() const { return QualityTier < EHumanAnimQualityTier::Low; }
+
+	bool IsServerLean() const { return QualityTier == EHumanAnimQualityTier::ServerLean; }
+
+	bool IsCosmeticUpdateAllowed() const { return !IsServerLean(); }
+
+	bool IsDynamicTransitionAllowed() const { return QualityTier < EHumanAnimQualityTier::Low; }
+
+	bool IsLookReduced() const { return QualityTier >= EHumanAnimQualityTier::Low; }
+
+	int32 GetFeetTraceInterval() const;
+
+#pragma endregion
+
+
 	//////////////////////////////////////////////////////////////
 	// Layering State
 #pragma region Layering State
@@ -58,6 +238,9 @@ protected:
 protected:
 	void UpdateLayering();
 
+public:
+	const FLayeringState& GetLayeringState() const { return LayeringState; }
+
 #pragma endregion
 
 
@@ -71,6 +254,9 @@ protected:
 protected:
 	void UpdatePose();
 
+public:
+	const FPoseState& GetPoseState() const { return PoseState; }
+
 #pragma endregion
 
 
@@ -87,6 +273,8 @@ protected:
 public:
 	virtual bool IsSpineRotationAllowed();
 
+	const FSpineRotationState& GetSpineRotationState() const { return SpineRotationState; }
+
 #pragma endregion
 
 
@@ -103,6 +291,18 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Look", Meta = (ClampMin = 0))
 	float LookTowardsInputYawAngleInterpolationSpeed{ 8.0f };
 
+	//
+	// Frame in which the look state was last updated.
+	// Used to skip redundant updates requested by multiple linked layers in the same frame.
+	//
+	uint64 LookUpdatedFrame{ MAX_uint64 };
+
+	//
+	// World time at which the look state was last updated.
+	// Used to interpolate over the real elapsed time, since the delta time of throttled updates already covers the skipped frames.
+	//
+	double LookUpdatedTime{ 0.0 };
+
 protected:
 	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance", Meta = (BlueprintProtected, BlueprintThreadSafe))
 	void ReinitializeLook();
@@ -110,6 +310,9 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance", Meta = (BlueprintProtected, BlueprintThreadSafe))
 	void UpdateLook();
 
+public:
+	const FLookState& GetLookState() const { return LookState; }
+
 #pragma endregion
 
 
@@ -175,6 +378,22 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|OnGround", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
 	float AnimatedCrouchSpeed{ 150.0f };
 
+	//
+	// Animated speeds and stride curves measured from the cycle sequences.
+	// When set, they are used instead of the animated speeds and stride curves above.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|OnGround")
+	TObjectPtr<const UHumanLocomotionSpeedSettings> SpeedSettings{ nullptr };
+
+protected:
+	float GetAnimatedWalkSpeed() const;
+	float GetAnimatedRunSpeed() const;
+	float GetAnimatedSprintSpeed() const;
+	float GetAnimatedCrouchSpeed() const;
+
+	float GetStrideBlendAmountWalk(float Speed) const;
+	float GetStrideBlendAmountRun(float Speed) const;
+
 protected:
 	void UpdateGroundedOnGameThread();
 
@@ -186,6 +405,14 @@ protected:
 
 	void UpdateRotationYawOffsets();
 
+	/**
+	 * Returns the current amount of acceleration/deceleration relative to the character's rotation
+	 * 
+	 * Tips:
+	 *	This value is normalized from -1 to 1, where -1 is the maximum brake deceleration and 1 is the maximum acceleration.
+	 */
+	FVector3f CalculateRelativeAccelerationAmount() const;
+
 	void UpdateSprint(const FVector3f& RelativeAccelerationAmount, float DeltaTime);
 
 	void UpdateStrideBlendAmount();
@@ -206,6 +433,9 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance", Meta = (BlueprintProtected, BlueprintThreadSafe))
 	void ActivatePivot();
 
+public:
+	const FOnGroundState& GetOnGroundState() const { return OnGroundState; }
+
 #pragma endregion
 
 
@@ -250,12 +480,16 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
 	FInWaterState InWaterState;
 
-protected:
-	void UpdateInWaterOnGameThread() {}
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|InWater", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float AnimatedSwimSpeed{ 200.0f };
 
-	void UpdateInWater(float DeltaTime) {}
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|InWater", Meta = (ClampMin = 0))
+	FVector2f SwimStrokePlayRate{ 0.5f, 2.0f };
+
+protected:
+	void UpdateInWaterOnGameThread();
 
-	void UpdateInWaterLeanAmount(float DeltaTime) {}
+	void UpdateInWater(float DeltaTime);
 
 #pragma endregion
 	
@@ -285,6 +519,11 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Feet", Meta = (ClampMin = 0, ForceUnits = "cm"))
 	float IkTraceDistanceDownward{ 45.0f };
 
+	//
+	// Bone indices of the current mesh shared with all instances using the same mesh
+	//
+	TSharedPtr<const FHumanMeshBoneCache, ESPMode::ThreadSafe> MeshBoneCache;
+
 protected:
 	void UpdateFeetOnGameThread();
 
@@ -300,6 +539,71 @@ protected:
 
 	void UpdateFootOffset(FFootState& FootState, float DeltaTime, FVector& FinalLocation, FQuat& FinalRotation) const;
 
+	void ApplyFootOffset(FFootState& FootState, float DeltaTime, FVector& FinalLocation, FQuat& FinalRotation) const;
+
+public:
+	const FFeetState& GetFeetState() const { return FeetState; }
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Footsteps
+#pragma region Footsteps
+protected:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
+	FFootstepState FootstepState;
+
+	//
+	// Whether to detect the footsteps from the foot lock and foot planted curves
+	// 
+	// Tips:
+	//	It also makes the foot IK traces return the physical material.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Footsteps")
+	bool bEnableFootsteps{ false };
+
+	//
+	// Effects played for the footsteps. No effect is played if it is not set.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Footsteps")
+	TObjectPtr<const UHumanFootstepEffectSettings> FootstepEffectSettings;
+
+	//
+	// Planted amount of the foot at which a footstep occurs
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Footsteps", Meta = (ClampMin = 0.01, ClampMax = 1))
+	float FootstepPlantThreshold{ 0.5f };
+
+	//
+	// Minimum time between the footsteps of the same foot
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Footsteps", Meta = (ClampMin = 0, ForceUnits = "s"))
+	float FootstepMinInterval{ 0.15f };
+
+public:
+	//
+	// Called on the game thread once per update with all the footsteps detected in that update
+	//
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FHumanFootstepsDelegate OnFootsteps;
+
+protected:
+	/**
+	 * Detect the footsteps from the rising edges of the planted amount of each foot
+	 * 
+	 * Tips:
+	 *	The surface is taken from the foot IK trace when it was traced in the same update.
+	 *	Otherwise (e.g. the trace interval of the lower quality tiers) the surface is traced again for the footstep only.
+	 */
+	void UpdateFootsteps(float DeltaTime);
+
+	void TraceFootstepSurface(const FVector& Location, TEnumAsByte<EPhysicalSurface>& OutSurfaceType, FVector& OutSurfaceNormal) const;
+
+	void DispatchFootstepsOnGameThread();
+
+	void PlayFootstepEffect(const FHumanFootstepEvent& Event);
+
 #pragma endregion
 
 
@@ -322,17 +626,33 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions", Meta = (ClampMin = 0, ForceUnits = "s"))
 	float QuickStopStartTime{ 0.3f };
 
+	//
+	// Whether to drive the quick stop and dynamic transition animations by distance when they have the distance to marker curve
+	//
+	// Tips:
+	//	The quick stop follows the predicted stop distance of the character and is never played faster than the maximum of QuickStopPlayRate.
+	//	The dynamic transition starts at the position where the remaining foot travel matches the foot lock distance.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
+	bool bUseDistanceMatching{ true };
+
+	//
+	// Minimum play rate of the distance matched quick stop, so that it still finishes when the predicted stop distance stops shrinking
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions", Meta = (ClampMin = 0.01, ForceUnits = "x", EditCondition = "bUseDistanceMatching"))
+	float DistanceMatchingMinPlayRate{ 0.5f };
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> StandingTransitionLeftAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> StandingTransitionLeftAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> StandingTransitionRightAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> StandingTransitionRightAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> CrouchingTransitionLeftAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> CrouchingTransitionLeftAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> CrouchingTransitionRightAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> CrouchingTransitionRightAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions", Meta = (ClampMin = 0, ForceUnits = "cm"))
 	float DynamicTransitionFootLockDistanceThreshold{ 8.0f };
@@ -343,25 +663,99 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions", Meta = (ClampMin = 0, ForceUnits = "x"))
 	float DynamicTransitionPlayRate{ 1.5f };
 
+	//
+	// Time during which the next dynamic transition is blocked after one has started
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions", Meta = (ClampMin = 0, ForceUnits = "s"))
+	float DynamicTransitionDelayTime{ 0.1f };
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> StandingDynamicTransitionLeftAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> StandingDynamicTransitionLeftAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> StandingDynamicTransitionRightAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> StandingDynamicTransitionRightAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> CrouchingDynamicTransitionLeftAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> CrouchingDynamicTransitionLeftAnimation;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
-	TObjectPtr<UAnimSequenceBase> CrouchingDynamicTransitionRightAnimation{ nullptr };
+	TSoftObjectPtr<UAnimSequenceBase> CrouchingDynamicTransitionRightAnimation;
+
+	//
+	// Whether to stream in the crouching transition animations at spawn instead of on the first crouch
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Transitions")
+	bool bLoadCrouchingTransitionAnimationsAtSpawn{ false };
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
+	FTransitionAnimationSet StandingTransitionAnimations;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
+	FTransitionAnimationSet CrouchingTransitionAnimations;
+
+	//
+	// Soft paths acquired from the shared cache, which are released when this instance is uninitialized
+	//
+	TArray<FSoftObjectPath> AcquiredTransitionAnimationPaths;
+
+	TWeakObjectPtr<UHumanAnimationSubsystem> TransitionAnimationCache;
+
+protected:
+	/**
+	 * Request the transition animations of the stance from the shared cache of UHumanAnimationSubsystem
+	 */
+	void RequestTransitionAnimations(bool bCrouching);
+
+	/**
+	 * Release all transition animations acquired by this instance
+	 */
+	void ReleaseTransitionAnimations();
+
+	void UpdateTransitionAnimationsOnGameThread();
+
+	/**
+	 * Resolve the animations of the set that have streamed in
+	 * 
+	 * Tips:
+	 *	Transitions whose animation is not resolved yet are skipped.
+	 */
+	void ResolveTransitionAnimations(FTransitionAnimationSet& Set, bool bCrouching) const;
+
+	/**
+	 * Returns the transition animations of the current stance
+	 */
+	const FTransitionAnimationSet& GetTransitionAnimations() const;
 
 protected:
-	void UpdateTransitions();
+	void UpdateTransitions(float DeltaTime);
 
-	void UpdateDynamicTransition();
+	void UpdateDynamicTransition(float DeltaTime);
 
 	void PlayQueuedDynamicTransitionAnimation();
 
+	/**
+	 * Play the animation at the position of the predicted stop distance and let UpdateDistanceMatchingOnGameThread() advance it
+	 * 
+	 * Tips:
+	 *	The montage is advanced by its play rate so that notifies and branching points still fire.
+	 *	It never plays slower than DistanceMatchingMinPlayRate, and blends out as soon as the character has input again.
+	 * 
+	 * @return False if the animation has no distance lookup table
+	 */
+	bool PlayDistanceMatchedTransitionAnimation(UAnimSequenceBase* Animation, float BlendInDuration, float BlendOutDuration);
+
+	void UpdateDistanceMatchingOnGameThread(float DeltaTime);
+
+	/**
+	 * Returns the horizontal distance that the character travels until it stops by braking, in the unscaled units of the animations
+	 */
+	float PredictStopDistance() const;
+
+	/**
+	 * Returns the curve summary of the animation if it has a valid distance lookup table
+	 */
+	static const UHumanCurveSummaryUserData* FindDistanceCurveSummary(const UAnimSequenceBase* Animation);
+
 public:
 	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance")
 	void PlayQuickStopAnimation();
@@ -419,12 +813,214 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Hand IK")
 	bool bUseHandIkBones{ true };
 
+	//
+	// Control rig input built in ControlRigInputBuiltFrame.
+	// Reused within the same frame so that multiple linked layers do not rebuild it.
+	//
+	mutable FControlRigInput CachedControlRigInput;
+
+	mutable uint64 ControlRigInputBuiltFrame{ MAX_uint64 };
+
+protected:
+	FControlRigInput BuildControlRigInput() const;
+
 public:
 	/**
 	 * Get data to pass to ControlRig in BlueprintThreadSafe
 	 */
 	UFUNCTION(BlueprintPure, Category = "Human Anim Instance", Meta = (BlueprintThreadSafe, ReturnDisplayName = "Rig Input"))
-	FControlRigInput GetControlRigInput() const;
+	const FControlRigInput& GetControlRigInput() const;
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Animation Sharing
+#pragma region Animation Sharing
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Animation Sharing", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float SharingIdleSpeedThreshold{ 10.0f };
+
+public:
+	/**
+	 * Returns the quantized locomotion state used as the key for animation sharing
+	 * 
+	 * Tips:
+	 *	The pose of a sharing actor is driven by its leader and this AnimInstance may not be updated.
+	 *	Therefore, mode, stance, gait, direction and rotation in place are derived from the character and its movement
+	 *	instead of the states updated by this AnimInstance.
+	 *	Transition montages are not part of the key because they are played by the update of this AnimInstance.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance")
+	EHumanAnimationSharingState ComputeAnimationSharingState() const;
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Linked Layer Pool
+#pragma region Linked Layer Pool
+protected:
+	//
+	// Linked layer classes that are instantiated and initialized at begin play.
+	// Linking them with LinkPooledAnimClassLayers() rebinds the layer nodes and registers the pooled instance with the mesh
+	// without creating a new instance.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Configs|Linked Layers")
+	TArray<TSubclassOf<UHumanLinkedAnimInstance>> PooledLinkedLayerClasses;
+
+	UPROPERTY(Transient)
+	TMap<TSubclassOf<UHumanLinkedAnimInstance>, TObjectPtr<UHumanLinkedAnimInstance>> LinkedLayerPool;
+
+protected:
+	void PrewarmLinkedLayerPool();
+
+	UHumanLinkedAnimInstance* FindOrCreatePooledLinkedLayer(TSubclassOf<UHumanLinkedAnimInstance> InClass);
+
+	void DestroyLinkedLayerPool();
+
+public:
+	/**
+	 * Links all layers implemented by InClass using the pooled instance of InClass
+	 * 
+	 * Tips:
+	 *	Falls back to LinkAnimClassLayers() if the instance could not be pooled.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance")
+	void LinkPooledAnimClassLayers(TSubclassOf<UHumanLinkedAnimInstance> InClass);
+
+	/**
+	 * Unlinks the layers bound to the pooled instance of InClass while keeping the instance in the pool
+	 * 
+	 * Tips:
+	 *	The instance is removed from the linked instances of the mesh, so it is no longer ticked until it is linked again.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Human Anim Instance")
+	void UnlinkPooledAnimClassLayers(TSubclassOf<UHumanLinkedAnimInstance> InClass);
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Linked Layer Snapshot
+#pragma region Linked Layer Snapshot
+protected:
+	//
+	// Buffer through which the states read by the linked layers are published.
+	// Shared with the linked layers so that they never read the states of this instance directly.
+	//
+	TSharedRef<FLinkedLayerSnapshotBuffer, ESPMode::ThreadSafe> LinkedLayerSnapshotBuffer{ MakeShared<FLinkedLayerSnapshotBuffer, ESPMode::ThreadSafe>() };
+
+protected:
+	/**
+	 * Copy the states to the back slot of LinkedLayerSnapshotBuffer and publish it
+	 * 
+	 * Tips:
+	 *	Called by the proxy after the thread safe update of this instance and before the linked layers are updated.
+	 */
+	void PublishLinkedLayerSnapshot();
+
+public:
+	TSharedRef<const FLinkedLayerSnapshotBuffer, ESPMode::ThreadSafe> GetLinkedLayerSnapshotBuffer() const { return LinkedLayerSnapshotBuffer; }
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Prewarm
+#pragma region Prewarm
+protected:
+	/**
+	 * Play Animation in the transition slot through the montage pool of UHumanAnimationSubsystem
+	 * 
+	 * Tips:
+	 *	Falls back to PlaySlotAnimationAsDynamicMontage() when the subsystem is not available.
+	 */
+	UAnimMontage* PlayPooledTransitionMontage(UAnimSequenceBase* Animation, float BlendInDuration, float BlendOutDuration, float PlayRate, float StartTime);
+
+public:
+	/**
+	 * Touch the curves and create the pooled transition montages of this class so that the first use does not hitch
+	 * 
+	 * Tips:
+	 *	Called on the class default object by UHumanAnimationSubsystem.
+	 */
+	virtual void Prewarm(UHumanAnimationSubsystem& Subsystem) const;
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Curve Read Elision
+#pragma region Curve Read Elision
+protected:
+	//
+	// Whether to skip reading the layering and pose curves while every active sequence keeps them constant at the same value
+	// 
+	// Tips:
+	//	It relies on UHumanCurveSummaryUserData of the sequences, which is added by the human curve modifiers.
+	//	The sequences are found from the tick records, so the reads are never elided for anim classes that contain nodes
+	//	producing curves without a tick record (sequence evaluators, pose assets, Modify Curve, Control Rig and the human cycle locomotion).
+	//	Curves set by other custom nodes are not taken into account.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Curve Read Elision")
+	bool bElideConstantCurveReads{ false };
+
+	//
+	// Time for which the active sequences must stay the same before the reads are elided, so that blends and inertialization settle
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Configs|Curve Read Elision", Meta = (ClampMin = 0, ForceUnits = "s", EditCondition = "bElideConstantCurveReads"))
+	float CurveReadElisionSettleTime{ 0.5f };
+
+	//
+	// Assets of the tick records gathered on the last update, in the order in which they were gathered
+	// 
+	// Tips:
+	//	The pointers are only compared and never dereferenced.
+	//
+	TArray<const UAnimationAsset*, TInlineAllocator<16>> CurveSourceAssets;
+
+	//
+	// Classes of this instance and its linked layers gathered on the last update, in the order in which they were gathered
+	//
+	TArray<const UClass*, TInlineAllocator<4>> CurveSourceClasses;
+
+	bool bCurveSourceAssetsValid{ false };
+
+	float CurveSourcesStableTime{ 0.0f };
+
+	bool bLayeringCurvesConstant{ false };
+	bool bPoseCurvesConstant{ false };
+
+	bool bLayeringCurvesElided{ false };
+	bool bPoseCurvesElided{ false };
+
+protected:
+	void UpdateCurveReadElisionOnGameThread(float DeltaTime);
+
+	/**
+	 * Gather the assets that contributed to the curves of the last evaluation from the tick records of this instance and its linked layers
+	 * 
+	 * @return False if the curves may come from a source that is not in the tick records (e.g. montages)
+	 */
+	bool GatherCurveSourceAssets(TArray<const UAnimationAsset*, TInlineAllocator<16>>& OutAssets, TArray<const UClass*, TInlineAllocator<4>>& OutClasses) const;
+
+	/**
+	 * Returns whether the anim class contains a node that produces curves without a tick record
+	 */
+	static bool HasUntrackedCurveNodes(const UClass* AnimClass);
+
+	/**
+	 * Expand the assets into the unique sequences they sample
+	 * 
+	 * @return False if one of the assets is neither a sequence nor a blend space
+	 */
+	static bool ExpandCurveSources(TConstArrayView<const UAnimationAsset*> Assets, TArray<const UAnimSequenceBase*, TInlineAllocator<16>>& OutSources);
+
+	/**
+	 * Returns whether all sources have the same constant value for each of the curves
+	 */
+	static bool AreCurvesConstant(TConstArrayView<const UAnimSequenceBase*> Sources, TConstArrayView<FName> CurveNames);
 
 #pragma endregion
 
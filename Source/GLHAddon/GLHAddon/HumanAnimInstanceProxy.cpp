@@ -2,6 +2,8 @@
 
 #include "HumanAnimInstanceProxy.h"
 
+#include "HumanAnimInstance.h"
+
 #include UE_INLINE_GENERATED_CPP_BY_NAME(HumanAnimInstanceProxy)
 
 
@@ -9,3 +11,15 @@ FHumanAnimInstanceProxy::FHumanAnimInstanceProxy(UAnimInstance* AnimationInstanc
 	: Super(AnimationInstance)
 {
 }
+
+void FHumanAnimInstanceProxy::UpdateAnimationNode(const FAnimationUpdateContext& InContext)
+{
+	// Publish the states updated in the thread safe update before the linked layers in the graph are updated.
+
+	if (auto* HumanAnimInstance{ Cast<UHumanAnimInstance>(GetAnimInstanceObject()) })
+	{
+		HumanAnimInstance->PublishLinkedLayerSnapshot();
+	}
+
+	Super::UpdateAnimationNode(InContext);
+}
@@ -28,4 +28,7 @@ public:
 
 	explicit FHumanAnimInstanceProxy(UAnimInstance* AnimationInstance);
 
+protected:
+	virtual void UpdateAnimationNode(const FAnimationUpdateContext& InContext) override;
+
 };
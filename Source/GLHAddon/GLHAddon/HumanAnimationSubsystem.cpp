@@ -0,0 +1,294 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanAnimationSubsystem.h"
+
+#include "HumanAnimInstance.h"
+#include "HumanSkeletonCacheRegistry.h"
+#include "LocomotionHumanNameStatics.h"
+#include "GLHAddonLogs.h"
+
+#include "Animation/AnimMontage.h"
+#include "Components/BrushComponent.h"
+#include "GameFramework/PhysicsVolume.h"
+#include "Engine/SkinnedAsset.h"
+#include "Engine/World.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanAnimationSubsystem)
+
+
+bool UHumanAnimationSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return (WorldType == EWorldType::Game) || (WorldType == EWorldType::PIE) ||
+		   (WorldType == EWorldType::EditorPreview) || (WorldType == EWorldType::GamePreview);
+}
+
+void UHumanAnimationSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (bPrewarmOnWorldBeginPlay && !IsRunningDedicatedServer())
+	{
+		Prewarm();
+	}
+}
+
+UHumanAnimationSubsystem* UHumanAnimationSubsystem::Get(const UWorld* World)
+{
+	return World ? World->GetSubsystem<UHumanAnimationSubsystem>() : nullptr;
+}
+
+
+#pragma region Prewarm
+
+void UHumanAnimationSubsystem::Prewarm()
+{
+	const auto StartTime{ FPlatformTime::Seconds() };
+
+	ULocomotionHumanNameStatics::InitializeNames();
+
+	auto NumClasses{ 0 };
+
+	for (const auto& SoftClass : PrewarmAnimInstanceClasses)
+	{
+		if (const auto* Class{ SoftClass.LoadSynchronous() })
+		{
+			GetDefault<UHumanAnimInstance>(Class)->Prewarm(*this);
+			NumClasses++;
+		}
+	}
+
+	auto NumMeshes{ 0 };
+
+	for (const auto& SoftMesh : PrewarmMeshes)
+	{
+		if (const auto* Mesh{ SoftMesh.LoadSynchronous() })
+		{
+			FHumanSkeletonCacheRegistry::Get().FindOrAddMeshBoneCache(Mesh);
+			NumMeshes++;
+		}
+	}
+
+	GLHALOG(TEXT("Prewarmed human animation in %.2f ms (%d AnimInstance classes, %d meshes, %d pooled montages)"),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0, NumClasses, NumMeshes, PooledMontages.Num());
+}
+
+#pragma endregion
+
+
+#pragma region Transition Montage Pool
+
+UAnimMontage* UHumanAnimationSubsystem::FindOrCreateSlotMontage(UAnimSequenceBase* Animation, FName SlotName, float BlendInDuration, float BlendOutDuration)
+{
+	if (!IsValid(Animation))
+	{
+		return nullptr;
+	}
+
+	const auto CurrentTime{ GetWorld()->GetTimeSeconds() };
+
+	if (CurrentTime >= NextMontagePruneTime)
+	{
+		RemoveIdlePooledMontages(CurrentTime);
+	}
+
+	const FMontageKey Key
+	{
+		Animation,
+		SlotName,
+		FMath::RoundToInt32(BlendInDuration / MontageBlendDurationStep),
+		FMath::RoundToInt32(BlendOutDuration / MontageBlendDurationStep)
+	};
+
+	if (auto* PooledMontage{ MontagePool.Find(Key) })
+	{
+		PooledMontage->LastUsedTime = CurrentTime;
+		return PooledMontage->Montage;
+	}
+
+	// Created in the same way as UAnimInstance::PlaySlotAnimationAsDynamicMontage() with the play rate left to Montage_Play().
+
+	auto* NewMontage
+	{
+		UAnimMontage::CreateSlotAnimationAsDynamicMontage(Animation, SlotName,
+			Key.BlendInSteps * MontageBlendDurationStep, Key.BlendOutSteps * MontageBlendDurationStep, 1.0f, 1, 0.0f, 0.0f)
+	};
+
+	if (NewMontage)
+	{
+		MontagePool.Add(Key, { NewMontage, CurrentTime });
+		PooledMontages.Add(NewMontage);
+	}
+
+	return NewMontage;
+}
+
+void UHumanAnimationSubsystem::RemovePooledMontages(const UAnimSequenceBase* Animation)
+{
+	for (auto It{ MontagePool.CreateIterator() }; It; ++It)
+	{
+		if (It.Key().Animation == Animation)
+		{
+			PooledMontages.RemoveSingleSwap(It.Value().Montage);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void UHumanAnimationSubsystem::RemoveIdlePooledMontages(double CurrentTime)
+{
+	// Montages of animations that were never acquired are not released by ReleaseAnimations(), so they expire here instead.
+
+	for (auto It{ MontagePool.CreateIterator() }; It; ++It)
+	{
+		if (CurrentTime - It.Value().LastUsedTime > PooledMontageIdleLifetime)
+		{
+			PooledMontages.RemoveSingleSwap(It.Value().Montage);
+			It.RemoveCurrent();
+		}
+	}
+
+	NextMontagePruneTime = CurrentTime + FMath::Max(PooledMontageIdleLifetime * 0.5f, 1.0f);
+}
+
+#pragma endregion
+
+
+#pragma region Animation Cache
+
+void UHumanAnimationSubsystem::AcquireAnimations(TConstArrayView<FSoftObjectPath> Paths)
+{
+	check(IsInGameThread());
+
+	for (const auto& Path : Paths)
+	{
+		if (Path.IsNull())
+		{
+			continue;
+		}
+
+		auto& CachedAnimation{ AnimationCache.FindOrAdd(Path) };
+
+		if (CachedAnimation.RefCount++ == 0)
+		{
+			CachedAnimation.Handle = StreamableManager.RequestAsyncLoad(Path);
+		}
+	}
+}
+
+void UHumanAnimationSubsystem::ReleaseAnimations(TConstArrayView<FSoftObjectPath> Paths)
+{
+	check(IsInGameThread());
+
+	for (const auto& Path : Paths)
+	{
+		auto* CachedAnimation{ AnimationCache.Find(Path) };
+
+		if (!CachedAnimation || --CachedAnimation->RefCount > 0)
+		{
+			continue;
+		}
+
+		// Pooled montages hold hard references to the animation, so they are removed together with it
+
+		if (const auto* Animation{ Cast<UAnimSequenceBase>(Path.ResolveObject()) })
+		{
+			RemovePooledMontages(Animation);
+		}
+
+		if (CachedAnimation->Handle.IsValid())
+		{
+			if (CachedAnimation->Handle->IsLoadingInProgress())
+			{
+				CachedAnimation->Handle->CancelHandle();
+			}
+			else
+			{
+				CachedAnimation->Handle->ReleaseHandle();
+			}
+		}
+
+		AnimationCache.Remove(Path);
+	}
+}
+
+#pragma endregion
+
+
+#pragma region Water Surface Cache
+
+FIntPoint UHumanAnimationSubsystem::GetWaterSurfaceCell(const FVector& Location) const
+{
+	const auto CellSize{ FMath::Max(WaterSurfaceCellSize, 1.0f) };
+
+	return FIntPoint(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+float UHumanAnimationSubsystem::FindOrQueryWaterSurfaceHeight(const APhysicsVolume* Volume, const FIntPoint& Cell)
+{
+	check(IsInGameThread());
+
+	const FWaterSurfaceKey Key{ Volume, Cell };
+	const auto& VolumeTransform{ Volume->GetActorTransform() };
+
+	auto* Entry{ WaterSurfaceHeights.Find(Key) };
+
+	if (Entry && Entry->VolumeTransform.Equals(VolumeTransform))
+	{
+		return Entry->SurfaceHeight;
+	}
+
+	// The map only grows on a miss, so the entries of destroyed volumes are removed here
+
+	if (!Entry)
+	{
+		PruneStaleWaterSurfaces();
+
+		Entry = &WaterSurfaceHeights.Add(Key);
+	}
+
+	// Queried at the center of the cell so that every swimmer in the cell gets the same height
+
+	const auto CellSize{ FMath::Max(WaterSurfaceCellSize, 1.0f) };
+	const FVector CellCenter{ (Cell.X + 0.5f) * CellSize, (Cell.Y + 0.5f) * CellSize, 0.0f };
+
+	Entry->SurfaceHeight = QueryWaterSurfaceHeight(Volume, CellCenter);
+	Entry->VolumeTransform = VolumeTransform;
+
+	return Entry->SurfaceHeight;
+}
+
+void UHumanAnimationSubsystem::PruneStaleWaterSurfaces()
+{
+	for (auto It{ WaterSurfaceHeights.CreateIterator() }; It; ++It)
+	{
+		if (!It.Key().Volume.ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+float UHumanAnimationSubsystem::QueryWaterSurfaceHeight(const APhysicsVolume* Volume, const FVector& Location)
+{
+	check(Volume);
+
+	const auto Bounds{ Volume->GetBounds().GetBox() };
+	const auto* BrushComponent{ Volume->GetBrushComponent() };
+
+	if (BrushComponent)
+	{
+		FHitResult Hit;
+
+		if (const_cast<UBrushComponent*>(BrushComponent)->LineTraceComponent(Hit,
+			FVector(Location.X, Location.Y, Bounds.Max.Z + 1.0f),
+			FVector(Location.X, Location.Y, Bounds.Min.Z - 1.0f),
+			FCollisionQueryParams(__FUNCTION__, false)))
+		{
+			return UE_REAL_TO_FLOAT(Hit.ImpactPoint.Z);
+		}
+	}
+
+	return UE_REAL_TO_FLOAT(Bounds.Max.Z);
+}
+
+#pragma endregion
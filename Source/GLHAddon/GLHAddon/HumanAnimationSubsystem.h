@@ -0,0 +1,263 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Subsystems/WorldSubsystem.h"
+
+#include "Engine/StreamableManager.h"
+
+#include "HumanAnimationSubsystem.generated.h"
+
+class UHumanAnimInstance;
+class USkinnedAsset;
+class UAnimMontage;
+class UAnimSequenceBase;
+class APhysicsVolume;
+
+
+/**
+ * World subsystem that warms up human animation resources on map load and pools the dynamic transition montages
+ * 
+ * Tips:
+ *	Archetypes to warm up are configured in the [/Script/GLHAddon.HumanAnimationSubsystem] section of DefaultGame.ini.
+ */
+UCLASS(Config = Game)
+class GLHADDON_API UHumanAnimationSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+public:
+	UHumanAnimationSubsystem() {}
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	static UHumanAnimationSubsystem* Get(const UWorld* World);
+
+
+	/////////////////////////////////////////
+	// Prewarm
+#pragma region Prewarm
+protected:
+	//
+	// Whether to warm up the configured archetypes when the world begins play
+	//
+	UPROPERTY(Config)
+	bool bPrewarmOnWorldBeginPlay{ true };
+
+	//
+	// AnimInstance classes whose curves and transition montages are warmed up
+	//
+	UPROPERTY(Config)
+	TArray<TSoftClassPtr<UHumanAnimInstance>> PrewarmAnimInstanceClasses;
+
+	//
+	// Meshes whose shared bone caches are resolved
+	//
+	UPROPERTY(Config)
+	TArray<TSoftObjectPtr<USkinnedAsset>> PrewarmMeshes;
+
+public:
+	/**
+	 * Initializes the name table, evaluates the curves, builds the montage pool and resolves the per-mesh caches of the configured archetypes
+	 */
+	void Prewarm();
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Transition Montage Pool
+#pragma region Transition Montage Pool
+protected:
+	struct FMontageKey
+	{
+	public:
+		TObjectKey<UAnimSequenceBase> Animation;
+
+		FName SlotName;
+
+		//
+		// Blend durations quantized by MontageBlendDurationStep
+		//
+		int32 BlendInSteps{ 0 };
+
+		int32 BlendOutSteps{ 0 };
+
+	public:
+		bool operator==(const FMontageKey& Other) const
+		{
+			return (Animation == Other.Animation) && (SlotName == Other.SlotName) &&
+				   (BlendInSteps == Other.BlendInSteps) && (BlendOutSteps == Other.BlendOutSteps);
+		}
+
+		friend uint32 GetTypeHash(const FMontageKey& Key)
+		{
+			return HashCombineFast(HashCombineFast(GetTypeHash(Key.Animation), GetTypeHash(Key.SlotName)),
+								   HashCombineFast(GetTypeHash(Key.BlendInSteps), GetTypeHash(Key.BlendOutSteps)));
+		}
+	};
+
+	struct FPooledMontage
+	{
+	public:
+		TObjectPtr<UAnimMontage> Montage;
+
+		double LastUsedTime{ 0.0 };
+	};
+
+	//
+	// Step by which the blend durations are rounded so that nearly equal settings share the same montage
+	//
+	static constexpr auto MontageBlendDurationStep{ 0.05f };
+
+	//
+	// Time after which a montage that has not been requested is removed from the pool.
+	// Montages that are still playing are kept alive by their AnimInstance.
+	//
+	UPROPERTY(Config)
+	float PooledMontageIdleLifetime{ 60.0f };
+
+	TMap<FMontageKey, FPooledMontage> MontagePool;
+
+	//
+	// Keeps the pooled montages alive
+	//
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UAnimMontage>> PooledMontages;
+
+	double NextMontagePruneTime{ 0.0 };
+
+public:
+	/**
+	 * Returns a dynamic montage that plays Animation in SlotName, which is created only once for each blend setting
+	 * 
+	 * Tips:
+	 *	The play rate and start time are not part of the montage and must be passed to Montage_Play().
+	 *	Blend durations are rounded to MontageBlendDurationStep.
+	 */
+	UAnimMontage* FindOrCreateSlotMontage(UAnimSequenceBase* Animation, FName SlotName, float BlendInDuration, float BlendOutDuration);
+
+	int32 GetNumPooledMontages() const { return PooledMontages.Num(); }
+
+protected:
+	void RemovePooledMontages(const UAnimSequenceBase* Animation);
+
+	/**
+	 * Removes the montages that have not been requested for PooledMontageIdleLifetime, whether or not their animation was acquired
+	 */
+	void RemoveIdlePooledMontages(double CurrentTime);
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Animation Cache
+#pragma region Animation Cache
+protected:
+	struct FCachedAnimation
+	{
+	public:
+		TSharedPtr<FStreamableHandle> Handle;
+
+		int32 RefCount{ 0 };
+	};
+
+	FStreamableManager StreamableManager;
+
+	//
+	// Soft referenced animations shared by all instances, which are unloaded when no instance acquires them
+	//
+	TMap<FSoftObjectPath, FCachedAnimation> AnimationCache;
+
+public:
+	/**
+	 * Start streaming in the animations of Paths if they are not already cached and add a reference to each of them
+	 */
+	void AcquireAnimations(TConstArrayView<FSoftObjectPath> Paths);
+
+	/**
+	 * Remove a reference to each of the animations of Paths and release those that are no longer referenced
+	 */
+	void ReleaseAnimations(TConstArrayView<FSoftObjectPath> Paths);
+
+	int32 GetNumCachedAnimations() const { return AnimationCache.Num(); }
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Water Surface Cache
+#pragma region Water Surface Cache
+protected:
+	struct FWaterSurfaceKey
+	{
+	public:
+		TObjectKey<APhysicsVolume> Volume;
+
+		FIntPoint Cell{ FIntPoint::ZeroValue };
+
+	public:
+		bool operator==(const FWaterSurfaceKey& Other) const
+		{
+			return (Volume == Other.Volume) && (Cell == Other.Cell);
+		}
+
+		friend uint32 GetTypeHash(const FWaterSurfaceKey& Key)
+		{
+			return HashCombineFast(GetTypeHash(Key.Volume), GetTypeHash(Key.Cell));
+		}
+	};
+
+	struct FWaterSurfaceEntry
+	{
+	public:
+		float SurfaceHeight{ 0.0f };
+
+		//
+		// Transform of the volume when the surface was queried, so that the surface of a moved volume is queried again
+		//
+		FTransform VolumeTransform{ FTransform::Identity };
+	};
+
+	//
+	// Horizontal size of the cells in which the surface height of a water volume is shared
+	//
+	UPROPERTY(Config)
+	float WaterSurfaceCellSize{ 400.0f };
+
+	//
+	// Surface heights of the water volumes shared by all swimmers
+	// 
+	// Tips:
+	//	Entries are keyed by weak object keys, so entries of destroyed volumes are removed by PruneStaleWaterSurfaces()
+	//
+	TMap<FWaterSurfaceKey, FWaterSurfaceEntry> WaterSurfaceHeights;
+
+public:
+	FIntPoint GetWaterSurfaceCell(const FVector& Location) const;
+
+	/**
+	 * Returns the surface height of the water volume at the cell, which is queried only the first time any swimmer enters the cell
+	 * or after the volume has moved
+	 */
+	float FindOrQueryWaterSurfaceHeight(const APhysicsVolume* Volume, const FIntPoint& Cell);
+
+	/**
+	 * Trace the volume alone from above to find its surface height at the location
+	 * 
+	 * Tips:
+	 *	Falls back to the top of the volume bounds if the location is outside the volume.
+	 */
+	static float QueryWaterSurfaceHeight(const APhysicsVolume* Volume, const FVector& Location);
+
+	int32 GetNumCachedWaterSurfaces() const { return WaterSurfaceHeights.Num(); }
+
+protected:
+	void PruneStaleWaterSurfaces();
+
+#pragma endregion
+
+};
@@ -0,0 +1,127 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanCurveSummaryUserData.h"
+
+#include "LocomotionHumanNameStatics.h"
+
+#include "Animation/AnimSequence.h"
+#include "UObject/ObjectSaveContext.h"
+
+#if WITH_EDITOR
+#include "Animation/AnimData/IAnimationDataModel.h"
+#endif
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanCurveSummaryUserData)
+
+
+#if WITH_EDITOR
+void FHumanDistanceLookupTable::Build(const FRichCurve& Curve, float PlayLength, int32 NumEntries)
+{
+	MaxDistance = 0.0f;
+	MarkerTime = 0.0f;
+	Times.Reset();
+
+	if ((PlayLength <= 0.0f) || (NumEntries < 2))
+	{
+		return;
+	}
+
+	// Sample the curve densely and keep the running minimum, so that the remaining distance never increases
+
+	const auto NumSamples{ NumEntries * 8 };
+
+	TArray<float> Distances;
+	Distances.SetNumUninitialized(NumSamples + 1);
+
+	auto RunningMin{ TNumericLimits<float>::Max() };
+
+	for (auto i{ 0 }; i <= NumSamples; i++)
+	{
+		RunningMin = FMath::Min(RunningMin, FMath::Max(0.0f, Curve.Eval(PlayLength * i / NumSamples)));
+		Distances[i] = RunningMin;
+	}
+
+	MaxDistance = Distances[0];
+
+	if (MaxDistance <= UE_KINDA_SMALL_NUMBER)
+	{
+		return;
+	}
+
+	// Invert at uniform distance steps by walking both sequences once
+
+	Times.SetNumUninitialized(NumEntries);
+
+	auto Sample{ 0 };
+
+	for (auto i{ 0 }; i < NumEntries; i++)
+	{
+		const auto Distance{ MaxDistance * (1.0f - static_cast<float>(i) / (NumEntries - 1)) };
+
+		while ((Sample < NumSamples) && (Distances[Sample + 1] > Distance))
+		{
+			Sample++;
+		}
+
+		if (Sample >= NumSamples)
+		{
+			Times[i] = PlayLength;
+			continue;
+		}
+
+		const auto Range{ Distances[Sample] - Distances[Sample + 1] };
+		const auto Alpha{ (Range > UE_SMALL_NUMBER) ? (Distances[Sample] - Distance) / Range : 0.0f };
+
+		Times[i] = PlayLength * (Sample + Alpha) / NumSamples;
+	}
+
+	MarkerTime = Times.Last();
+}
+
+void UHumanCurveSummaryUserData::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+
+	// Curves may have been edited after the modifiers were applied, so the summary is rebuilt before it is saved or cooked
+
+	if (const auto* Sequence{ GetTypedOuter<UAnimSequence>() })
+	{
+		Refresh(Sequence);
+	}
+}
+
+void UHumanCurveSummaryUserData::Refresh(const UAnimSequence* Sequence)
+{
+	check(Sequence);
+
+	CurveSummaries.Reset();
+	DistanceLookupTable = FHumanDistanceLookupTable();
+
+	for (const auto& FloatCurve : Sequence->GetDataModel()->GetFloatCurves())
+	{
+		auto& Summary{ CurveSummaries.Add(FloatCurve.GetName()) };
+
+		if (FloatCurve.FloatCurve.GetNumKeys() > 0)
+		{
+			FloatCurve.FloatCurve.GetValueRange(Summary.MinValue, Summary.MaxValue);
+		}
+
+		if (FloatCurve.GetName() == ULocomotionHumanNameStatics::DistanceToMarkerCurveName())
+		{
+			DistanceLookupTable.Build(FloatCurve.FloatCurve, Sequence->GetPlayLength());
+		}
+	}
+}
+#endif
+
+bool UHumanCurveSummaryUserData::GetConstantValue(const FName& CurveName, float& OutValue) const
+{
+	if (const auto* Summary{ CurveSummaries.Find(CurveName) })
+	{
+		OutValue = Summary->MinValue;
+		return Summary->IsConstant();
+	}
+
+	OutValue = 0.0f;
+	return true;
+}
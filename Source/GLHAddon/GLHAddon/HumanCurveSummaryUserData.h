@@ -0,0 +1,127 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/AssetUserData.h"
+
+#include "HumanCurveSummaryUserData.generated.h"
+
+class UAnimSequence;
+struct FRichCurve;
+
+
+/**
+ * Range of the values of a float curve in the sequence
+ */
+USTRUCT(BlueprintType)
+struct FHumanCurveSummary
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	float MinValue = 0.0f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	float MaxValue = 0.0f;
+
+public:
+	bool IsConstant() const { return FMath::IsNearlyEqual(MinValue, MaxValue); }
+};
+
+
+/**
+ * Inverse of the distance to marker curve of the sequence, which maps the remaining distance to the time at uniform distance steps
+ * 
+ * Tips:
+ *	The curve is made non-increasing before it is inverted, so that the lookup never moves the time backward.
+ */
+USTRUCT(BlueprintType)
+struct GLHADDON_API FHumanDistanceLookupTable
+{
+	GENERATED_BODY()
+public:
+	//
+	// Remaining distance at the start of the sequence
+	//
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "", Meta = (ForceUnits = "cm"))
+	float MaxDistance = 0.0f;
+
+	//
+	// Time at which the remaining distance reaches zero
+	//
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "", Meta = (ForceUnits = "s"))
+	float MarkerTime = 0.0f;
+
+	//
+	// Time at each remaining distance from MaxDistance down to zero
+	//
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	TArray<float> Times;
+
+public:
+	bool IsValid() const { return (Times.Num() >= 2) && (MaxDistance > UE_KINDA_SMALL_NUMBER); }
+
+	/**
+	 * Returns the time at which the remaining distance of the sequence equals RemainingDistance
+	 */
+	float GetTimeAtDistance(float RemainingDistance) const
+	{
+		const auto Position{ (1.0f - FMath::Clamp(RemainingDistance / MaxDistance, 0.0f, 1.0f)) * (Times.Num() - 1) };
+		const auto Index{ FMath::Min(FMath::FloorToInt32(Position), Times.Num() - 2) };
+
+		return FMath::Lerp(Times[Index], Times[Index + 1], Position - Index);
+	}
+
+#if WITH_EDITOR
+	/**
+	 * Rebuild the table by sampling the distance to marker curve
+	 */
+	void Build(const FRichCurve& Curve, float PlayLength, int32 NumEntries = 64);
+#endif
+};
+
+
+/**
+ * Asset user data of the sequence that summarizes its float curves, so that the curves can be analyzed at runtime without evaluating them
+ * 
+ * Tips:
+ *	Added by the human curve modifiers and refreshed every time the sequence is saved or cooked.
+ *	Curves that are not in the summary are not present in the sequence.
+ */
+UCLASS()
+class GLHADDON_API UHumanCurveSummaryUserData : public UAssetUserData
+{
+	GENERATED_BODY()
+public:
+	UHumanCurveSummaryUserData() {}
+
+protected:
+	UPROPERTY(VisibleAnywhere, Category = "Curve Summary")
+	TMap<FName, FHumanCurveSummary> CurveSummaries;
+
+	//
+	// Built only if the sequence has the distance to marker curve
+	//
+	UPROPERTY(VisibleAnywhere, Category = "Curve Summary")
+	FHumanDistanceLookupTable DistanceLookupTable;
+
+public:
+#if WITH_EDITOR
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+
+	/**
+	 * Rebuild the summary from the curves of the sequence
+	 */
+	void Refresh(const UAnimSequence* Sequence);
+#endif
+
+	const FHumanCurveSummary* FindCurveSummary(const FName& CurveName) const { return CurveSummaries.Find(CurveName); }
+
+	/**
+	 * Returns whether the curve has the same value throughout the sequence and that value, which is 0 if the curve is not present
+	 */
+	bool GetConstantValue(const FName& CurveName, float& OutValue) const;
+
+	const FHumanDistanceLookupTable& GetDistanceLookupTable() const { return DistanceLookupTable; }
+
+};
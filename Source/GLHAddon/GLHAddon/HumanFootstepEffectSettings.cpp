@@ -0,0 +1,49 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanFootstepEffectSettings.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanFootstepEffectSettings)
+
+
+void UHumanFootstepEffectSettings::PostLoad()
+{
+	Super::PostLoad();
+
+	BuildEffectTable();
+}
+
+#if WITH_EDITOR
+void UHumanFootstepEffectSettings::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BuildEffectTable();
+}
+#endif
+
+void UHumanFootstepEffectSettings::BuildEffectTable()
+{
+	EffectTable.Init(DefaultEffect, SurfaceType_Max);
+
+	for (const auto& KVP : SurfaceEffects)
+	{
+		if (KVP.Key < SurfaceType_Max)
+		{
+			EffectTable[KVP.Key] = KVP.Value;
+		}
+	}
+}
+
+const FHumanFootstepEffect& UHumanFootstepEffectSettings::FindEffect(EPhysicalSurface SurfaceType) const
+{
+	if (EffectTable.IsValidIndex(SurfaceType))
+	{
+		return EffectTable[SurfaceType];
+	}
+
+	// Settings created at runtime are not loaded, so the table may not be built
+
+	const auto* Effect{ SurfaceEffects.Find(SurfaceType) };
+
+	return Effect ? *Effect : DefaultEffect;
+}
@@ -0,0 +1,81 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+
+#include "Engine/EngineTypes.h"
+
+#include "HumanFootstepEffectSettings.generated.h"
+
+class USoundBase;
+class USoundAttenuation;
+
+
+/**
+ * Effects played for a footstep on a surface
+ */
+USTRUCT(BlueprintType)
+struct FHumanFootstepEffect
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "")
+	TObjectPtr<USoundBase> Sound = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "", Meta = (ClampMin = 0))
+	float VolumeMultiplier = 1.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "", Meta = (ClampMin = 0))
+	float PitchMultiplier = 1.0f;
+};
+
+
+/**
+ * Footstep effects of each physical surface used by UHumanAnimInstance
+ * 
+ * Tips:
+ *	SurfaceEffects is flattened into a table indexed by the surface type on load, so that each footstep is a single lookup.
+ */
+UCLASS(BlueprintType)
+class GLHADDON_API UHumanFootstepEffectSettings : public UDataAsset
+{
+	GENERATED_BODY()
+public:
+	UHumanFootstepEffectSettings() {}
+
+protected:
+	//
+	// Effect of the surfaces that are not in SurfaceEffects
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Effects")
+	FHumanFootstepEffect DefaultEffect;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Effects")
+	TMap<TEnumAsByte<EPhysicalSurface>, FHumanFootstepEffect> SurfaceEffects;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Effects")
+	TObjectPtr<USoundAttenuation> SoundAttenuation;
+
+	//
+	// Effect of each surface type indexed by EPhysicalSurface
+	//
+	UPROPERTY(Transient)
+	TArray<FHumanFootstepEffect> EffectTable;
+
+public:
+	virtual void PostLoad() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+protected:
+	void BuildEffectTable();
+
+public:
+	const FHumanFootstepEffect& FindEffect(EPhysicalSurface SurfaceType) const;
+
+	USoundAttenuation* GetSoundAttenuation() const { return SoundAttenuation; }
+
+};
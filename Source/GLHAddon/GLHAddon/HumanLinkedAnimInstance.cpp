@@ -37,13 +37,46 @@ void UHumanLinkedAnimInstance::NativeInitializeAnimation()
 		{
 			Character = GetMutableDefault<ALocomotionCharacter>();
 		}
+
+		ParentSnapshotBuffer = Parent->GetLinkedLayerSnapshotBuffer();
 		return;
 	}
 #endif
 
-	auto* Mesh{ ICharacterMeshAccessorInterface::Execute_GetMainMesh(Character) };
-	
-	Parent = Mesh ? Cast<UHumanAnimInstance>(Mesh->GetAnimInstance()) : nullptr;
+	// Keep the Parent assigned by the pool or the previous initialization as long as it still drives the same mesh.
+
+	if (!Parent.IsValid() || (Parent->GetSkelMeshComponent() != GetSkelMeshComponent()))
+	{
+		// Linked layers run on the main mesh, so try its main AnimInstance before asking the Character for the main mesh.
+
+		Parent = Cast<UHumanAnimInstance>(GetSkelMeshComponent()->GetAnimInstance());
+
+		if (!Parent.IsValid())
+		{
+			auto* Mesh{ ICharacterMeshAccessorInterface::Execute_GetMainMesh(Character) };
+
+			Parent = Mesh ? Cast<UHumanAnimInstance>(Mesh->GetAnimInstance()) : nullptr;
+		}
+	}
+
+	if (Parent.IsValid())
+	{
+		ParentSnapshotBuffer = Parent->GetLinkedLayerSnapshotBuffer();
+	}
+	else
+	{
+		ParentSnapshotBuffer.Reset();
+	}
+}
+
+void UHumanLinkedAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	if (ParentSnapshotBuffer.IsValid())
+	{
+		ParentState = ParentSnapshotBuffer->Read();
+	}
 }
 
 void UHumanLinkedAnimInstance::NativeBeginPlay()
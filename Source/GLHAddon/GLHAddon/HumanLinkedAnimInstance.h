@@ -2,6 +2,8 @@
 
 #include "Animation/AnimInstance.h"
 
+#include "State/LinkedLayerSnapshot.h"
+
 #include "HumanLinkedAnimInstance.generated.h"
 
 class ALocomotionCharacter;
@@ -18,6 +20,9 @@ UCLASS()
 class GLHADDON_API UHumanLinkedAnimInstance : public UAnimInstance
 {
 	GENERATED_BODY()
+
+	friend UHumanAnimInstance;
+
 public:
 	UHumanLinkedAnimInstance();
 
@@ -34,9 +39,20 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Refarence", Transient)
 	TObjectPtr<ALocomotionCharacter> Character;
 
+	//
+	// Copy of the Parent states taken at the beginning of the thread safe update of this AnimInstance.
+	// Safe to read from anywhere in this AnimInstance, including the worker thread.
+	//
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "State", Transient)
+	FLinkedLayerSnapshot ParentState;
+
+	TSharedPtr<const FLinkedLayerSnapshotBuffer, ESPMode::ThreadSafe> ParentSnapshotBuffer;
+
 public:
 	virtual void NativeInitializeAnimation() override;
 
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
+
 	virtual void NativeBeginPlay() override;
 
 protected:
@@ -51,6 +67,7 @@ protected:
 	// It is safe to read variables that are modified only inside Parent's UCharacterAnimationInstance::NativeUpdateAnimation()
 	// 
 	// If you don't know what you are doing, access the variable through the Parent variable
+	// or read the ParentState snapshot instead
 	//
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = " Linked Animation Instance", Meta = (BlueprintProtected, BlueprintThreadSafe, ReturnDisplayName = "Parent"))
 	UHumanAnimInstance* GetParentUnsafe() const;
@@ -16,6 +16,14 @@ class GLHADDON_API UHumanLocomotionFunctionLibrary : public UBlueprintFunctionLi
 	GENERATED_BODY()
 
 public:
+	//
+	// Longest time step that SpringDamp() integrates at once.
+	// Larger steps, e.g. from reduced update rates, are split so that the spring stays stable.
+	//
+	static constexpr float SpringMaxSubstepDeltaTime{ 1.0f / 60.0f };
+
+	static constexpr int32 SpringMaxSubstepCount{ 8 };
+
 	template <typename ValueType, typename StateType>
 	static ValueType SpringDamp(const ValueType& Current, const ValueType& Target, StateType& SpringState, float DeltaTime, float Frequency, float DampingRatio, float TargetVelocityAmount = 1.0f)
 	{
@@ -38,10 +46,19 @@ public:
 			(TargetVelocityAmount <= 0.0f) ? 0.0f : (TargetVelocityAmount >= 1.0f) ? 1.0f : TargetVelocityAmount
 		};
 
+		const auto TargetVelocity{ (Target - SpringState.PreviousTarget) * (ClampedTargetVelocityAmount / DeltaTime) };
+
+		const auto SubstepCount{ FMath::Clamp(FMath::CeilToInt(DeltaTime / SpringMaxSubstepDeltaTime), 1, SpringMaxSubstepCount) };
+		const auto SubstepDeltaTime{ DeltaTime / SubstepCount };
+
 		ValueType Result{ Current };
-		FMath::SpringDamper(Result, SpringState.Velocity, Target,
-			(Target - SpringState.PreviousTarget) * (ClampedTargetVelocityAmount / DeltaTime),
-			DeltaTime, Frequency, DampingRatio);
+
+		for (auto i{ 1 }; i <= SubstepCount; ++i)
+		{
+			const ValueType SubstepTarget{ FMath::Lerp(SpringState.PreviousTarget, Target, static_cast<float>(i) / SubstepCount) };
+
+			FMath::SpringDamper(Result, SpringState.Velocity, SubstepTarget, TargetVelocity, SubstepDeltaTime, Frequency, DampingRatio);
+		}
 
 		SpringState.PreviousTarget = Target;
 
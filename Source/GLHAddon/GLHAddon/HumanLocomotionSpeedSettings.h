@@ -0,0 +1,97 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+
+#include "Curves/CurveFloat.h"
+
+#include "HumanLocomotionSpeedSettings.generated.h"
+
+class UAnimSequence;
+
+
+/**
+ * Animated locomotion speeds and stride blend curves measured from the cycle sequences
+ * 
+ * Tips:
+ *	Values are generated in the editor by UHumanLocomotionSpeedExtractionLibrary from the source sequences.
+ *	When assigned to UHumanAnimInstance, they are used instead of its hand-tuned animated speeds and stride curves.
+ */
+UCLASS(BlueprintType)
+class GLHADDON_API UHumanLocomotionSpeedSettings : public UDataAsset
+{
+	GENERATED_BODY()
+public:
+	UHumanLocomotionSpeedSettings() {}
+
+	/////////////////////////////////////////
+	// Generated
+#pragma region Generated
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generated", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float AnimatedWalkSpeed{ 150.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generated", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float AnimatedRunSpeed{ 350.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generated", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float AnimatedSprintSpeed{ 600.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generated", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float AnimatedCrouchSpeed{ 150.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generated")
+	FRuntimeFloatCurve StrideBlendAmountWalkCurve;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Generated")
+	FRuntimeFloatCurve StrideBlendAmountRunCurve;
+
+public:
+	float EvaluateStrideBlendAmountWalk(float Speed) const
+	{
+		return StrideBlendAmountWalkCurve.GetRichCurveConst()->Eval(Speed);
+	}
+
+	float EvaluateStrideBlendAmountRun(float Speed) const
+	{
+		return StrideBlendAmountRunCurve.GetRichCurveConst()->Eval(Speed);
+	}
+
+#pragma endregion
+
+
+	/////////////////////////////////////////
+	// Source
+#pragma region Source
+#if WITH_EDITORONLY_DATA
+public:
+	UPROPERTY(EditAnywhere, Category = "Source")
+	TSoftObjectPtr<UAnimSequence> WalkSequence;
+
+	UPROPERTY(EditAnywhere, Category = "Source")
+	TSoftObjectPtr<UAnimSequence> RunSequence;
+
+	UPROPERTY(EditAnywhere, Category = "Source")
+	TSoftObjectPtr<UAnimSequence> SprintSequence;
+
+	UPROPERTY(EditAnywhere, Category = "Source")
+	TSoftObjectPtr<UAnimSequence> CrouchSequence;
+
+	//
+	// Stride blend amount at zero speed. The stride curves rise linearly to 1 at the animated speed.
+	//
+	UPROPERTY(EditAnywhere, Category = "Source", Meta = (ClampMin = 0, ClampMax = 1))
+	float MinStrideBlendAmount{ 0.2f };
+
+	//
+	// Whether to measure the speed also from the planted feet, which is required for in-place sequences.
+	// Disable it to measure only the root motion.
+	//
+	UPROPERTY(EditAnywhere, Category = "Source")
+	bool bMeasureFromFeet{ true };
+#endif
+
+#pragma endregion
+
+};
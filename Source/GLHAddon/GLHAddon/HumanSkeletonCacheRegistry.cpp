@@ -0,0 +1,203 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanSkeletonCacheRegistry.h"
+
+#include "LocomotionHumanNameStatics.h"
+
+#include "Animation/Skeleton.h"
+#include "Engine/SkinnedAsset.h"
+
+
+#pragma region Tables
+
+bool FHumanMeshBoneCache::IsValidFor(const USkinnedAsset* InMesh) const
+{
+	return (Mesh.Get() == InMesh) && InMesh && (InMesh->GetRefSkeleton().GetNum() == NumBones);
+}
+
+bool FHumanLayeringRegionTable::IsValidFor(const USkeleton* InSkeleton) const
+{
+	return (Skeleton.Get() == InSkeleton) && InSkeleton && (InSkeleton->GetReferenceSkeleton().GetNum() == SkeletonBoneRegions.Num());
+}
+
+bool FHumanLayeringRegionTable::IsBuiltFrom(const TMap<FName, EHumanLayeringRegion>& InRegionRootBones) const
+{
+	return RegionRootBones.OrderIndependentCompareEqual(InRegionRootBones);
+}
+
+#pragma endregion
+
+
+#pragma region Registry
+
+FHumanSkeletonCacheRegistry& FHumanSkeletonCacheRegistry::Get()
+{
+	static FHumanSkeletonCacheRegistry Registry;
+	return Registry;
+}
+
+TSharedPtr<const FHumanMeshBoneCache, ESPMode::ThreadSafe> FHumanSkeletonCacheRegistry::FindOrAddMeshBoneCache(const USkinnedAsset* Mesh)
+{
+	if (!Mesh)
+	{
+		return nullptr;
+	}
+
+	const TObjectKey<USkinnedAsset> Key{ Mesh };
+
+	{
+		FReadScopeLock ReadLock{ Lock };
+
+		const auto* Cache{ MeshBoneCaches.Find(Key) };
+
+		if (Cache && (*Cache)->IsValidFor(Mesh))
+		{
+			return *Cache;
+		}
+	}
+
+	auto NewCache{ BuildMeshBoneCache(Mesh) };
+
+	FWriteScopeLock WriteLock{ Lock };
+
+	PruneStaleEntries();
+
+	MeshBoneCaches.Add(Key, NewCache);
+
+	return NewCache;
+}
+
+TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe> FHumanSkeletonCacheRegistry::FindOrAddLayeringRegionTable(const USkeleton* Skeleton, const TMap<FName, EHumanLayeringRegion>& RegionRootBones)
+{
+	if (!Skeleton)
+	{
+		return nullptr;
+	}
+
+	const TObjectKey<USkeleton> Key{ Skeleton };
+
+	{
+		FReadScopeLock ReadLock{ Lock };
+
+		if (const auto* Tables{ LayeringRegionTables.Find(Key) })
+		{
+			for (const auto& Table : *Tables)
+			{
+				if (Table->IsValidFor(Skeleton) && Table->IsBuiltFrom(RegionRootBones))
+				{
+					return Table;
+				}
+			}
+		}
+	}
+
+	auto NewTable{ BuildLayeringRegionTable(Skeleton, RegionRootBones) };
+
+	FWriteScopeLock WriteLock{ Lock };
+
+	PruneStaleEntries();
+
+	// Tables that were built before the skeleton changed are replaced as well.
+
+	auto& Tables{ LayeringRegionTables.FindOrAdd(Key) };
+
+	Tables.RemoveAll(
+		[Skeleton, &RegionRootBones](const TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe>& Table)
+		{
+			return !Table->IsValidFor(Skeleton) || Table->IsBuiltFrom(RegionRootBones);
+		});
+
+	Tables.Add(NewTable);
+
+	return NewTable;
+}
+
+void FHumanSkeletonCacheRegistry::Reset()
+{
+	FWriteScopeLock WriteLock{ Lock };
+
+	MeshBoneCaches.Reset();
+	LayeringRegionTables.Reset();
+}
+
+void FHumanSkeletonCacheRegistry::PruneStaleEntries()
+{
+	for (auto It{ MeshBoneCaches.CreateIterator() }; It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It{ LayeringRegionTables.CreateIterator() }; It; ++It)
+	{
+		if (!It.Key().ResolveObjectPtr())
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+TSharedPtr<const FHumanMeshBoneCache, ESPMode::ThreadSafe> FHumanSkeletonCacheRegistry::BuildMeshBoneCache(const USkinnedAsset* Mesh)
+{
+	auto NewCache{ MakeShared<FHumanMeshBoneCache, ESPMode::ThreadSafe>() };
+
+	const auto& ReferenceSkeleton{ Mesh->GetRefSkeleton() };
+
+	NewCache->Mesh = Mesh;
+	NewCache->NumBones = ReferenceSkeleton.GetNum();
+
+	const auto SetBoneIndex
+	{
+		[&NewCache, &ReferenceSkeleton](EHumanCachedBone Bone, const FName& BoneName)
+		{
+			NewCache->BoneIndices[static_cast<uint8>(Bone)] = ReferenceSkeleton.FindBoneIndex(BoneName);
+		}
+	};
+
+	SetBoneIndex(EHumanCachedBone::Pelvis,				ULocomotionHumanNameStatics::PelvisBoneName());
+	SetBoneIndex(EHumanCachedBone::Head,				ULocomotionHumanNameStatics::HeadBoneName());
+	SetBoneIndex(EHumanCachedBone::Spine03,				ULocomotionHumanNameStatics::Spine03BoneName());
+	SetBoneIndex(EHumanCachedBone::FootLeft,			ULocomotionHumanNameStatics::FootLeftBoneName());
+	SetBoneIndex(EHumanCachedBone::FootRight,			ULocomotionHumanNameStatics::FootRightBoneName());
+	SetBoneIndex(EHumanCachedBone::HandLeftGunVirtual,	ULocomotionHumanNameStatics::HandLeftGunVirtualBoneName());
+	SetBoneIndex(EHumanCachedBone::HandRightGunVirtual,	ULocomotionHumanNameStatics::HandRightGunVirtualBoneName());
+	SetBoneIndex(EHumanCachedBone::FootLeftIk,			ULocomotionHumanNameStatics::FootLeftIkBoneName());
+	SetBoneIndex(EHumanCachedBone::FootRightIk,			ULocomotionHumanNameStatics::FootRightIkBoneName());
+	SetBoneIndex(EHumanCachedBone::FootLeftVirtual,		ULocomotionHumanNameStatics::FootLeftVirtualBoneName());
+	SetBoneIndex(EHumanCachedBone::FootRightVirtual,	ULocomotionHumanNameStatics::FootRightVirtualBoneName());
+
+	return NewCache;
+}
+
+TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe> FHumanSkeletonCacheRegistry::BuildLayeringRegionTable(const USkeleton* Skeleton, const TMap<FName, EHumanLayeringRegion>& RegionRootBones)
+{
+	auto NewTable{ MakeShared<FHumanLayeringRegionTable, ESPMode::ThreadSafe>() };
+
+	const auto& ReferenceSkeleton{ Skeleton->GetReferenceSkeleton() };
+	const auto NumBones{ ReferenceSkeleton.GetNum() };
+
+	NewTable->Skeleton = Skeleton;
+	NewTable->RegionRootBones = RegionRootBones;
+	NewTable->SkeletonBoneRegions.SetNumUninitialized(NumBones);
+
+	// Parents always precede their children in the reference skeleton, so the region can be inherited in a single pass.
+
+	for (auto i{ 0 }; i < NumBones; i++)
+	{
+		if (const auto* Region{ RegionRootBones.Find(ReferenceSkeleton.GetBoneName(i)) })
+		{
+			NewTable->SkeletonBoneRegions[i] = *Region;
+			continue;
+		}
+
+		const auto ParentIndex{ ReferenceSkeleton.GetParentIndex(i) };
+
+		NewTable->SkeletonBoneRegions[i] = (ParentIndex != INDEX_NONE) ? NewTable->SkeletonBoneRegions[ParentIndex] : EHumanLayeringRegion::None;
+	}
+
+	return NewTable;
+}
+
+#pragma endregion
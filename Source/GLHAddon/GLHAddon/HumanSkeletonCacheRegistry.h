@@ -0,0 +1,142 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimNode/AnimNode_HumanLayering.h"
+
+#include "UObject/ObjectKey.h"
+
+class USkeleton;
+class USkinnedAsset;
+
+
+/**
+ * Bones of the human character that are looked up by index instead of by name
+ */
+enum class EHumanCachedBone : uint8
+{
+	Pelvis,
+	Head,
+	Spine03,
+	FootLeft,
+	FootRight,
+	HandLeftGunVirtual,
+	HandRightGunVirtual,
+	FootLeftIk,
+	FootRightIk,
+	FootLeftVirtual,
+	FootRightVirtual,
+
+	MAX
+};
+
+
+/**
+ * Mesh bone indices of EHumanCachedBone resolved once per mesh
+ * 
+ * Tips:
+ *	It is resolved from the mesh rather than the skeleton so that the virtual bones of the mesh are included.
+ */
+struct GLHADDON_API FHumanMeshBoneCache
+{
+public:
+	FHumanMeshBoneCache() = default;
+
+public:
+	TWeakObjectPtr<const USkinnedAsset> Mesh;
+
+	int32 NumBones{ 0 };
+
+	int32 BoneIndices[static_cast<uint8>(EHumanCachedBone::MAX)];
+
+public:
+	int32 GetBoneIndex(EHumanCachedBone Bone) const
+	{
+		return BoneIndices[static_cast<uint8>(Bone)];
+	}
+
+	bool IsValidFor(const USkinnedAsset* InMesh) const;
+
+};
+
+
+/**
+ * Region of each skeleton bone for FAnimNode_HumanLayering resolved once per skeleton and region settings
+ */
+struct GLHADDON_API FHumanLayeringRegionTable
+{
+public:
+	FHumanLayeringRegionTable() = default;
+
+public:
+	TWeakObjectPtr<const USkeleton> Skeleton;
+
+	//
+	// Region settings from which the table was built
+	//
+	TMap<FName, EHumanLayeringRegion> RegionRootBones;
+
+	//
+	// Region of each bone indexed by skeleton bone index
+	//
+	TArray<EHumanLayeringRegion> SkeletonBoneRegions;
+
+public:
+	bool IsValidFor(const USkeleton* InSkeleton) const;
+
+	bool IsBuiltFrom(const TMap<FName, EHumanLayeringRegion>& InRegionRootBones) const;
+
+};
+
+
+/**
+ * Registry of the bone and layering tables shared by all human AnimInstances and anim nodes using the same mesh or skeleton
+ * 
+ * Tips:
+ *	Curves are read by name because the animation curves of the engine are keyed by FName, so only the bones are cached here.
+ */
+class GLHADDON_API FHumanSkeletonCacheRegistry
+{
+public:
+	static FHumanSkeletonCacheRegistry& Get();
+
+private:
+	FRWLock Lock;
+
+	//
+	// Caches are keyed by weak object keys, so entries of unloaded assets are removed by PruneStaleEntries()
+	//
+	TMap<TObjectKey<USkinnedAsset>, TSharedPtr<const FHumanMeshBoneCache, ESPMode::ThreadSafe>> MeshBoneCaches;
+
+	//
+	// Tables of each skeleton, one for each different region settings
+	//
+	TMap<TObjectKey<USkeleton>, TArray<TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe>>> LayeringRegionTables;
+
+public:
+	/**
+	 * Returns the bone cache of the mesh and builds it if it has not been built yet or the mesh has changed
+	 */
+	TSharedPtr<const FHumanMeshBoneCache, ESPMode::ThreadSafe> FindOrAddMeshBoneCache(const USkinnedAsset* Mesh);
+
+	/**
+	 * Returns the region table of the skeleton for the region settings and builds it if it has not been built yet or the skeleton has changed
+	 */
+	TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe> FindOrAddLayeringRegionTable(const USkeleton* Skeleton, const TMap<FName, EHumanLayeringRegion>& RegionRootBones);
+
+	/**
+	 * Releases all caches. Instances that still hold them keep using their copy.
+	 */
+	void Reset();
+
+private:
+	/**
+	 * Removes the caches whose mesh or skeleton has been unloaded. Must be called with the write lock held.
+	 */
+	void PruneStaleEntries();
+
+	static TSharedPtr<const FHumanMeshBoneCache, ESPMode::ThreadSafe> BuildMeshBoneCache(const USkinnedAsset* Mesh);
+
+	static TSharedPtr<const FHumanLayeringRegionTable, ESPMode::ThreadSafe> BuildLayeringRegionTable(const USkeleton* Skeleton, const TMap<FName, EHumanLayeringRegion>& RegionRootBones);
+
+};
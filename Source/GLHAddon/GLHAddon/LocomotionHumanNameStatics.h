@@ -31,6 +31,27 @@ public:
 		return Name;
 	}
 
+	UFUNCTION(BlueprintPure, Category = "Human|Bones", Meta = (ReturnDisplayName = "Bone Name"))
+	static const FName& Neck01BoneName()
+	{
+		static const FName Name = FName(TEXTVIEW("neck_01"));
+		return Name;
+	}
+
+	UFUNCTION(BlueprintPure, Category = "Human|Bones", Meta = (ReturnDisplayName = "Bone Name"))
+	static const FName& Spine01BoneName()
+	{
+		static const FName Name = FName(TEXTVIEW("spine_01"));
+		return Name;
+	}
+
+	UFUNCTION(BlueprintPure, Category = "Human|Bones", Meta = (ReturnDisplayName = "Bone Name"))
+	static const FName& Spine02BoneName()
+	{
+		static const FName Name = FName(TEXTVIEW("spine_02"));
+		return Name;
+	}
+
 	UFUNCTION(BlueprintPure, Category = "Human|Bones", Meta = (ReturnDisplayName = "Bone Name"))
 	static const FName& Spine03BoneName()
 	{
@@ -373,4 +394,74 @@ public:
 		return Name;
 	}
 
+	UFUNCTION(BlueprintPure, Category = "Human|Animation Curves", Meta = (ReturnDisplayName = "Curve Name"))
+	static const FName& DistanceToMarkerCurveName()
+	{
+		static const FName Name = FName(TEXTVIEW("DistanceToMarker"));
+		return Name;
+	}
+
+
+	/////////////////////////////////////
+	// Initialization
+
+	/**
+	 * Initializes all function-local names so that the first animation update does not pay for it
+	 */
+	static void InitializeNames()
+	{
+		PelvisBoneName();
+		HeadBoneName();
+		Neck01BoneName();
+		Spine01BoneName();
+		Spine02BoneName();
+		Spine03BoneName();
+		FootLeftBoneName();
+		FootRightBoneName();
+		HandLeftGunVirtualBoneName();
+		HandRightGunVirtualBoneName();
+		FootLeftIkBoneName();
+		FootRightIkBoneName();
+		FootLeftVirtualBoneName();
+		FootRightVirtualBoneName();
+		TransitionSlotName();
+		LayerHeadCurveName();
+		LayerHeadAdditiveCurveName();
+		LayerHeadSlotCurveName();
+		LayerArmLeftCurveName();
+		LayerArmLeftAdditiveCurveName();
+		LayerArmLeftLocalSpaceCurveName();
+		LayerArmLeftSlotCurveName();
+		LayerArmRightCurveName();
+		LayerArmRightAdditiveCurveName();
+		LayerArmRightLocalSpaceCurveName();
+		LayerArmRightSlotCurveName();
+		LayerHandLeftCurveName();
+		LayerHandRightCurveName();
+		LayerSpineCurveName();
+		LayerSpineAdditiveCurveName();
+		LayerSpineSlotCurveName();
+		LayerPelvisCurveName();
+		LayerPelvisSlotCurveName();
+		LayerLegsCurveName();
+		LayerLegsSlotCurveName();
+		HandLeftIkCurveName();
+		HandRightIkCurveName();
+		HipsDirectionLockCurveName();
+		PoseGaitCurveName();
+		PoseMovingCurveName();
+		PoseStandingCurveName();
+		PoseCrouchingCurveName();
+		PoseGroundedCurveName();
+		PoseInAirCurveName();
+		FootLeftIkCurveName();
+		FootLeftLockCurveName();
+		FootRightIkCurveName();
+		FootRightLockCurveName();
+		FootPlantedCurveName();
+		FeetCrossingCurveName();
+		SprintBlockCurveName();
+		DistanceToMarkerCurveName();
+	}
+
 };
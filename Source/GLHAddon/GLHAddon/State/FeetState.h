@@ -4,6 +4,8 @@
 
 #include "State/SpringState.h"
 
+#include "Engine/EngineTypes.h"
+
 #include "FeetState.generated.h"
 
 USTRUCT(BlueprintType)
@@ -61,6 +63,21 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
 	FQuat IkRotation = FQuat(ForceInit);
+
+	//
+	// Surface under the foot found by the last IK trace
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FVector SurfaceNormal = FVector::UpVector;
+
+	//
+	// Whether the surface was found by the IK trace of the current update, rather than left over from an earlier one
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	bool bSurfaceUpToDate = false;
 };
 
 USTRUCT(BlueprintType)
@@ -0,0 +1,58 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Engine/EngineTypes.h"
+
+#include "FootstepState.generated.h"
+
+/**
+ * Footstep detected from the foot curves of the human character
+ */
+USTRUCT(BlueprintType)
+struct FHumanFootstepEvent
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	bool bLeftFoot = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FVector Location = FVector(ForceInit);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FVector SurfaceNormal = FVector::UpVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	TEnumAsByte<EPhysicalSurface> SurfaceType = SurfaceType_Default;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ForceUnits = "cm/s"))
+	float Speed = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float SoundBlockAmount = 0.0f;
+};
+
+USTRUCT(BlueprintType)
+struct FFootstepState
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float LeftPlantedAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float RightPlantedAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ForceUnits = "s"))
+	float LeftCooldownTime = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ForceUnits = "s"))
+	float RightCooldownTime = 0.0f;
+
+	//
+	// Footsteps detected in this update, which are dispatched together on the game thread
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	TArray<FHumanFootstepEvent> PendingEvents;
+};
@@ -11,7 +11,31 @@ struct FInWaterState
 	GENERATED_BODY()
 
 public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSwimming{ false };
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bUnderwater{ false };
 
+	//
+	// World height of the water surface above the character
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float SurfaceHeight{ 0.0f };
+
+	//
+	// Depth of the bottom of the capsule below the water surface, in the unscaled units of the animations
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ForceUnits = "cm"))
+	float SubmersionDepth{ 0.0f };
+
+	//
+	// Part of the capsule below the water surface
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, ClampMax = 1))
+	float SubmersionAmount{ 0.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Meta = (ClampMin = 0, ForceUnits = "x"))
+	float StrokePlayRate{ 1.0f };
+
 };
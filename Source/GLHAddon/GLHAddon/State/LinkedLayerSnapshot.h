@@ -0,0 +1,101 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "State/PoseState.h"
+#include "State/LayeringState.h"
+#include "State/OnGroundState.h"
+
+#include <atomic>
+
+#include "LinkedLayerSnapshot.generated.h"
+
+
+USTRUCT(BlueprintType)
+struct FFeetSummaryState
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = -1, ClampMax = 1))
+	float FootPlantedAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float FeetCrossingAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float FootLeftIkAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float FootLeftLockAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float FootRightIkAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ClampMin = 0, ClampMax = 1))
+	float FootRightLockAmount = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FVector2D MinMaxPelvisOffsetZ = FVector2D(ForceInit);
+};
+
+
+/**
+ * Copy of the parent states that linked layers need, published once per frame
+ *
+ * Tips:
+ *	The look state is not included because the linked layers update it with RefreshLook after the snapshot is published.
+ *	Read it from the parent after calling RefreshLook instead.
+ */
+USTRUCT(BlueprintType)
+struct FLinkedLayerSnapshot
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FPoseState PoseState;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FLayeringState LayeringState;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FOnGroundState OnGroundState;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FFeetSummaryState FeetSummary;
+};
+
+
+/**
+ * Double buffer through which the parent publishes FLinkedLayerSnapshot to the linked layers
+ * 
+ * Tips:
+ *	The parent writes to the back slot and flips it, so a published snapshot is never modified while it is the front slot.
+ *	Readers must finish copying the snapshot before the parent publishes twice more, which is always the case within a frame.
+ */
+struct FLinkedLayerSnapshotBuffer
+{
+public:
+	FLinkedLayerSnapshotBuffer() = default;
+
+private:
+	FLinkedLayerSnapshot Slots[2];
+
+	std::atomic<int32> FrontIndex{ 0 };
+
+public:
+	FLinkedLayerSnapshot& GetBackSlot()
+	{
+		return Slots[1 - FrontIndex.load(std::memory_order_relaxed)];
+	}
+
+	void Publish()
+	{
+		FrontIndex.store(1 - FrontIndex.load(std::memory_order_relaxed), std::memory_order_release);
+	}
+
+	const FLinkedLayerSnapshot& Read() const
+	{
+		return Slots[FrontIndex.load(std::memory_order_acquire)];
+	}
+
+};
@@ -0,0 +1,31 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "SleepState.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSleepState
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	bool bSleeping = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	bool bWakeRequested = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	int32 QuiescentFrames = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FVector ReferenceLocation = FVector(ForceInit);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	FRotator ReferenceViewRotation = FRotator(ForceInit);
+
+	//
+	// Values of the attribute curves in the order they were iterated when the quiescence began
+	//
+	TArray<TPair<FName, float>> ReferenceCurveValues;
+};
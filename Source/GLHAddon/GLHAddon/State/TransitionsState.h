@@ -5,6 +5,8 @@
 #include "TransitionsState.generated.h"
 
 class UAnimSequenceBase;
+class UAnimMontage;
+class UHumanCurveSummaryUserData;
 
 USTRUCT(BlueprintType)
 struct FTransitionsState
@@ -14,9 +16,58 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
 	bool bTransitionsAllowed = false;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
-	int32 DynamicTransitionsFrameDelay = 0;
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ForceUnits = "s"))
+	float DynamicTransitionsDelayTime = 0.0f;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
 	TObjectPtr<UAnimSequenceBase> QueuedDynamicTransitionAnimation = nullptr;
+
+	//
+	// Distance that the foot of the queued dynamic transition has to travel
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "", Meta = (ForceUnits = "cm"))
+	float QueuedDynamicTransitionDistance = 0.0f;
+
+	//
+	// Montage whose position is driven by the predicted stop distance instead of time
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	TObjectPtr<UAnimMontage> DistanceMatchedMontage = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "")
+	TObjectPtr<const UHumanCurveSummaryUserData> DistanceMatchedCurveSummary = nullptr;
+};
+
+
+/**
+ * Transition animations of a stance resolved from their soft references once they have streamed in
+ */
+USTRUCT(BlueprintType)
+struct FTransitionAnimationSet
+{
+	GENERATED_BODY()
+public:
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	TObjectPtr<UAnimSequenceBase> TransitionLeftAnimation = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	TObjectPtr<UAnimSequenceBase> TransitionRightAnimation = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	TObjectPtr<UAnimSequenceBase> DynamicTransitionLeftAnimation = nullptr;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	TObjectPtr<UAnimSequenceBase> DynamicTransitionRightAnimation = nullptr;
+
+	//
+	// Whether the soft references of this set have been requested from the cache
+	//
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	bool bRequested = false;
+
+	//
+	// Whether some requested animations have not streamed in yet
+	//
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "")
+	bool bPending = false;
 };
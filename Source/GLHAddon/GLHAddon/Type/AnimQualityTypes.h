@@ -0,0 +1,42 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimQualityTypes.generated.h"
+
+
+/**
+ * Quality of the human animation update resolved from the animation budget and update rate
+ */
+UENUM(BlueprintType)
+enum class EHumanAnimQualityTier : uint8
+{
+	//
+	// Updated every frame with all features
+	//
+	High,
+
+	//
+	// Update rate is reduced. Feet traces are cached between updates.
+	//
+	Medium,
+
+	//
+	// Animation budget allocator asked to reduce work.
+	// Ground prediction and dynamic transitions are disabled and look is updated less often.
+	//
+	Low,
+
+	//
+	// Server only mode that computes just the states affecting the evaluated pose used for hit registration.
+	// No traces are run and no sockets are read on the game thread.
+	//
+	// Valid states:
+	//	LocomotionState, ViewState, PoseState, SpineRotationState, RotateInPlaceState,
+	//	OnGroundState and InAirState (except GroundPredictionAmount, which is always 0)
+	//
+	// States held at their defaults:
+	//	LayeringState, LookState, LeanState, FeetState, TransitionsState
+	//
+	ServerLean
+};
@@ -0,0 +1,41 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "HumanAnimationSharingTypes.generated.h"
+
+
+/**
+ * Quantized human locomotion state used as the key for animation sharing
+ * 
+ * Tips:
+ *	Actors with the same state share the pose of the same leader, so the values should be mapped one-to-one to the animations of the sharing setup.
+ */
+UENUM(BlueprintType)
+enum class EHumanAnimationSharingState : uint8
+{
+	StandingIdle,
+	StandingRotateLeft,
+	StandingRotateRight,
+	StandingWalkForward,
+	StandingWalkBackward,
+	StandingWalkLeft,
+	StandingWalkRight,
+	StandingRunForward,
+	StandingRunBackward,
+	StandingRunLeft,
+	StandingRunRight,
+	StandingSprint,
+
+	CrouchingIdle,
+	CrouchingRotateLeft,
+	CrouchingRotateRight,
+	CrouchingWalkForward,
+	CrouchingWalkBackward,
+	CrouchingWalkLeft,
+	CrouchingWalkRight,
+
+	InAir,
+
+	MAX		UMETA(Hidden)
+};
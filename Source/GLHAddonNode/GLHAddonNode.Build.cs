@@ -24,6 +24,7 @@ public class GLHAddonNode : ModuleRules
 				"Engine", 
 				"AnimationModifiers", 
 				"AnimationBlueprintLibrary",
+				"AssetRegistry",
                 "GLExt",
                 "GLHAddon",
             }
@@ -36,7 +37,8 @@ public class GLHAddonNode : ModuleRules
 				{
 					"AnimGraph",
 					"AnimGraphRuntime",
-					"BlueprintGraph"
+					"BlueprintGraph",
+					"UnrealEd"
 				}
 			);
 		}
@@ -0,0 +1,30 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimGraphNode_HumanCycleLocomotion.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimGraphNode_HumanCycleLocomotion)
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_HumanCycleLocomotion"
+
+
+FText UAnimGraphNode_HumanCycleLocomotion::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("NodeTitle", "Human Cycle Locomotion");
+}
+
+FText UAnimGraphNode_HumanCycleLocomotion::GetTooltipText() const
+{
+	return LOCTEXT("NodeTooltip", "Blends the directional locomotion cycles of each gait and stance using the On Ground State");
+}
+
+FString UAnimGraphNode_HumanCycleLocomotion::GetNodeCategory() const
+{
+	return TEXT("Human Locomotion");
+}
+
+FLinearColor UAnimGraphNode_HumanCycleLocomotion::GetNodeTitleColor() const
+{
+	return FLinearColor(0.2f, 0.8f, 0.2f);
+}
+
+#undef LOCTEXT_NAMESPACE
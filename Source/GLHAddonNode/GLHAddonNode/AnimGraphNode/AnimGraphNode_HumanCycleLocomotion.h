@@ -0,0 +1,32 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimGraphNode_Base.h"
+
+#include "AnimNode/AnimNode_HumanCycleLocomotion.h"
+
+#include "AnimGraphNode_HumanCycleLocomotion.generated.h"
+
+
+/**
+ * Anim graph node of FAnimNode_HumanCycleLocomotion
+ */
+UCLASS()
+class GLHADDONNODE_API UAnimGraphNode_HumanCycleLocomotion : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+public:
+	UAnimGraphNode_HumanCycleLocomotion() {}
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FAnimNode_HumanCycleLocomotion Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+	virtual FLinearColor GetNodeTitleColor() const override;
+
+};
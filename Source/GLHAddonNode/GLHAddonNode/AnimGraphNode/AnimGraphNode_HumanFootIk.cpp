@@ -0,0 +1,30 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimGraphNode_HumanFootIk.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimGraphNode_HumanFootIk)
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_HumanFootIk"
+
+
+FText UAnimGraphNode_HumanFootIk::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return GetControllerDescription();
+}
+
+FText UAnimGraphNode_HumanFootIk::GetTooltipText() const
+{
+	return LOCTEXT("NodeTooltip", "Applies the foot IK and pelvis offset of the Feet State with two bone IK");
+}
+
+FString UAnimGraphNode_HumanFootIk::GetNodeCategory() const
+{
+	return TEXT("Human Locomotion");
+}
+
+FText UAnimGraphNode_HumanFootIk::GetControllerDescription() const
+{
+	return LOCTEXT("ControllerDescription", "Human Foot IK");
+}
+
+#undef LOCTEXT_NAMESPACE
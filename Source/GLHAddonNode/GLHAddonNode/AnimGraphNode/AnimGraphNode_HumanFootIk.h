@@ -0,0 +1,35 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimGraphNode_SkeletalControlBase.h"
+
+#include "AnimNode/AnimNode_HumanFootIk.h"
+
+#include "AnimGraphNode_HumanFootIk.generated.h"
+
+
+/**
+ * Anim graph node of FAnimNode_HumanFootIk
+ */
+UCLASS()
+class GLHADDONNODE_API UAnimGraphNode_HumanFootIk : public UAnimGraphNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+public:
+	UAnimGraphNode_HumanFootIk() {}
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FAnimNode_HumanFootIk Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+
+protected:
+	virtual FText GetControllerDescription() const override;
+	virtual const FAnimNode_SkeletalControlBase* GetNode() const override { return &Node; }
+
+};
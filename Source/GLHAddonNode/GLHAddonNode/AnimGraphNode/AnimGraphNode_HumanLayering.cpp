@@ -0,0 +1,30 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimGraphNode_HumanLayering.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimGraphNode_HumanLayering)
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_HumanLayering"
+
+
+FText UAnimGraphNode_HumanLayering::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("NodeTitle", "Human Layering");
+}
+
+FText UAnimGraphNode_HumanLayering::GetTooltipText() const
+{
+	return LOCTEXT("NodeTooltip", "Applies the overlay, additive and slot amounts of the Layering State to each body region in a single pass");
+}
+
+FString UAnimGraphNode_HumanLayering::GetNodeCategory() const
+{
+	return TEXT("Human Locomotion");
+}
+
+FLinearColor UAnimGraphNode_HumanLayering::GetNodeTitleColor() const
+{
+	return FLinearColor(0.2f, 0.8f, 0.2f);
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,32 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimGraphNode_Base.h"
+
+#include "AnimNode/AnimNode_HumanLayering.h"
+
+#include "AnimGraphNode_HumanLayering.generated.h"
+
+
+/**
+ * Anim graph node of FAnimNode_HumanLayering
+ */
+UCLASS()
+class GLHADDONNODE_API UAnimGraphNode_HumanLayering : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+public:
+	UAnimGraphNode_HumanLayering() {}
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FAnimNode_HumanLayering Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+	virtual FLinearColor GetNodeTitleColor() const override;
+
+};
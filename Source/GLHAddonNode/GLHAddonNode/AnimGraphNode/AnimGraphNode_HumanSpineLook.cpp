@@ -0,0 +1,30 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimGraphNode_HumanSpineLook.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimGraphNode_HumanSpineLook)
+
+#define LOCTEXT_NAMESPACE "AnimGraphNode_HumanSpineLook"
+
+
+FText UAnimGraphNode_HumanSpineLook::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return GetControllerDescription();
+}
+
+FText UAnimGraphNode_HumanSpineLook::GetTooltipText() const
+{
+	return LOCTEXT("NodeTooltip", "Distributes the spine rotation and look angles over the spine, neck and head bones");
+}
+
+FString UAnimGraphNode_HumanSpineLook::GetNodeCategory() const
+{
+	return TEXT("Human Locomotion");
+}
+
+FText UAnimGraphNode_HumanSpineLook::GetControllerDescription() const
+{
+	return LOCTEXT("ControllerDescription", "Human Spine Rotation and Look");
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,35 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimGraphNode_SkeletalControlBase.h"
+
+#include "AnimNode/AnimNode_HumanSpineLook.h"
+
+#include "AnimGraphNode_HumanSpineLook.generated.h"
+
+
+/**
+ * Anim graph node of FAnimNode_HumanSpineLook
+ */
+UCLASS()
+class GLHADDONNODE_API UAnimGraphNode_HumanSpineLook : public UAnimGraphNode_SkeletalControlBase
+{
+	GENERATED_BODY()
+public:
+	UAnimGraphNode_HumanSpineLook() {}
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Settings")
+	FAnimNode_HumanSpineLook Node;
+
+public:
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FString GetNodeCategory() const override;
+
+protected:
+	virtual FText GetControllerDescription() const override;
+	virtual const FAnimNode_SkeletalControlBase* GetNode() const override { return &Node; }
+
+};
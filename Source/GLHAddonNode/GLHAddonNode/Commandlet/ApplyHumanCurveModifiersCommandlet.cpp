@@ -0,0 +1,296 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ApplyHumanCurveModifiersCommandlet.h"
+
+#include "Modifier/AnimationModifier_HumanCurvesBase.h"
+
+#include "Animation/AnimSequence.h"
+#include "Async/ParallelFor.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "ScopedTransaction.h"
+#include "UObject/SavePackage.h"
+#include "UObject/UObjectIterator.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ApplyHumanCurveModifiersCommandlet)
+
+DEFINE_LOG_CATEGORY_STATIC(LogApplyHumanCurveModifiers, Log, All);
+
+#define LOCTEXT_NAMESPACE "ApplyHumanCurveModifiersCommandlet"
+
+
+int32 UApplyHumanCurveModifiersCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	const auto ParseList
+	{
+		[&ParamValues](const TCHAR* Key, const TCHAR* Default)
+		{
+			TArray<FString> Values;
+			const auto* Value{ ParamValues.Find(Key) };
+			(Value ? *Value : FString(Default)).ParseIntoArray(Values, TEXT("+"));
+			return Values;
+		}
+	};
+
+	const auto Paths{ ParseList(TEXT("Paths"), TEXT("/Game")) };
+	const auto ModifierClassNames{ ParseList(TEXT("Modifiers"), TEXT("")) };
+	const auto SkeletonPath{ ParamValues.FindRef(TEXT("Skeleton")) };
+	const auto* BatchSizeValue{ ParamValues.Find(TEXT("BatchSize")) };
+	const auto BatchSize{ BatchSizeValue ? FMath::Max(1, FCString::Atoi(**BatchSizeValue)) : 256 };
+	const auto bForce{ Switches.Contains(TEXT("Force")) };
+
+	auto ManifestFilename{ ParamValues.FindRef(TEXT("Manifest")) };
+
+	if (ManifestFilename.IsEmpty())
+	{
+		ManifestFilename = FPaths::ProjectSavedDir() / TEXT("HumanCurveModifiers.manifest");
+	}
+
+	// Modifiers
+
+	TArray<const UAnimationModifier_HumanCurvesBase*> Modifiers;
+	GatherModifiers(ModifierClassNames, Modifiers);
+
+	if (Modifiers.IsEmpty())
+	{
+		UE_LOG(LogApplyHumanCurveModifiers, Error, TEXT("No human curve modifier to apply"));
+		return 1;
+	}
+
+	// Sequences
+
+	TArray<FAssetData> Assets;
+	GatherSequences(Paths, SkeletonPath, Assets);
+
+	UE_LOG(LogApplyHumanCurveModifiers, Display, TEXT("Found %d sequences, %d modifiers"), Assets.Num(), Modifiers.Num());
+
+	// Skip the packages whose hash matches the manifest. The package files are hashed in parallel.
+
+	TMap<FName, FString> Manifest;
+
+	if (!bForce)
+	{
+		LoadManifest(ManifestFilename, Manifest);
+	}
+
+	const auto ModifiersHash{ ComputeModifiersHash(Modifiers) };
+
+	auto PendingAssets{ Assets };
+	RemoveUpToDateAssets(Manifest, ModifiersHash, PendingAssets);
+
+	UE_LOG(LogApplyHumanCurveModifiers, Display, TEXT("%d sequences are up to date, %d to process"), Assets.Num() - PendingAssets.Num(), PendingAssets.Num());
+
+	// Process in batches so that the memory is bounded, and update the manifest after each batch so that an interrupted run can resume.
+
+	auto NumFailed{ 0 };
+
+	for (auto Start{ 0 }; Start < PendingAssets.Num(); Start += BatchSize)
+	{
+		const auto Batch{ TConstArrayView<FAssetData>(PendingAssets).Mid(Start, BatchSize) };
+
+		TArray<FName> SavedPackages;
+		NumFailed += ProcessBatch(Batch, Modifiers, SavedPackages);
+
+		for (const auto& PackageName : SavedPackages)
+		{
+			Manifest.Add(PackageName, ComputePackageHash(PackageName, ModifiersHash));
+		}
+
+		SaveManifest(ManifestFilename, Manifest);
+
+		CollectGarbage(RF_NoFlags);
+
+		UE_LOG(LogApplyHumanCurveModifiers, Display, TEXT("Processed %d / %d"), FMath::Min(Start + BatchSize, PendingAssets.Num()), PendingAssets.Num());
+	}
+
+	UE_LOG(LogApplyHumanCurveModifiers, Display, TEXT("Finished (%d failed)"), NumFailed);
+
+	return (NumFailed > 0) ? 1 : 0;
+}
+
+
+void UApplyHumanCurveModifiersCommandlet::GatherModifiers(const TArray<FString>& ClassNames, TArray<const UAnimationModifier_HumanCurvesBase*>& OutModifiers) const
+{
+	if (ClassNames.IsEmpty())
+	{
+		for (TObjectIterator<UClass> It; It; ++It)
+		{
+			if (It->IsChildOf<UAnimationModifier_HumanCurvesBase>() && !It->HasAnyClassFlags(CLASS_Abstract | CLASS_Deprecated | CLASS_NewerVersionExists))
+			{
+				const auto* Modifier{ GetDefault<UAnimationModifier_HumanCurvesBase>(*It) };
+
+				if (Modifier->IsAppliedByDefault())
+				{
+					OutModifiers.Add(Modifier);
+				}
+			}
+		}
+
+		// Modifiers that analyze the bones are applied last so that their curves replace the placeholder curves of the same names
+
+		OutModifiers.StableSort([](const UAnimationModifier_HumanCurvesBase& A, const UAnimationModifier_HumanCurvesBase& B)
+		{
+			TArray<FName> BonesA, BonesB;
+			A.GetRequiredBones(BonesA);
+			B.GetRequiredBones(BonesB);
+
+			return BonesA.IsEmpty() && !BonesB.IsEmpty();
+		});
+
+		return;
+	}
+
+	for (const auto& ClassName : ClassNames)
+	{
+		const auto* Class{ UClass::TryFindTypeSlow<UClass>(ClassName) };
+
+		if (!Class)
+		{
+			Class = LoadClass<UAnimationModifier_HumanCurvesBase>(nullptr, *ClassName);
+		}
+
+		if (Class && Class->IsChildOf<UAnimationModifier_HumanCurvesBase>())
+		{
+			OutModifiers.Add(GetDefault<UAnimationModifier_HumanCurvesBase>(Class));
+		}
+		else
+		{
+			UE_LOG(LogApplyHumanCurveModifiers, Warning, TEXT("%s is not a human curve modifier class"), *ClassName);
+		}
+	}
+}
+
+FString UApplyHumanCurveModifiersCommandlet::ComputeModifiersHash(const TArray<const UAnimationModifier_HumanCurvesBase*>& Modifiers) const
+{
+	// Settings are hashed through their text export so that changing them reprocesses all sequences
+
+	FMD5 Md5;
+
+	for (const auto* Modifier : Modifiers)
+	{
+		auto Text{ Modifier->GetClass()->GetPathName() };
+
+		for (TFieldIterator<FProperty> It(Modifier->GetClass()); It; ++It)
+		{
+			It->ExportTextItem_InContainer(Text, Modifier, nullptr, nullptr, PPF_None);
+		}
+
+		const FTCHARToUTF8 Utf8(*Text);
+		Md5.Update(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	FMD5Hash Hash;
+	Hash.Set(Md5);
+
+	return LexToString(Hash);
+}
+
+int32 UApplyHumanCurveModifiersCommandlet::ProcessBatch(TConstArrayView<FAssetData> Assets, const TArray<const UAnimationModifier_HumanCurvesBase*>& Modifiers, TArray<FName>& OutSavedPackages) const
+{
+	auto NumFailed{ 0 };
+
+	// Load and read the sequences on the game thread
+
+	TArray<FName> RequiredBoneNames;
+
+	for (const auto* Modifier : Modifiers)
+	{
+		Modifier->GetRequiredBones(RequiredBoneNames);
+	}
+
+	TArray<UAnimSequence*> Sequences;
+	TArray<FHumanCurveSequenceInfo> Infos;
+	Sequences.Reserve(Assets.Num());
+	Infos.Reserve(Assets.Num());
+
+	for (const auto& Asset : Assets)
+	{
+		if (auto* Sequence{ Cast<UAnimSequence>(Asset.GetAsset()) })
+		{
+			Sequences.Add(Sequence);
+			Infos.Emplace(Sequence, RequiredBoneNames);
+		}
+		else
+		{
+			UE_LOG(LogApplyHumanCurveModifiers, Error, TEXT("Failed to load %s"), *Asset.GetObjectPathString());
+			NumFailed++;
+		}
+	}
+
+	// Compute the curves on the worker threads.
+	// Every modifier sees the curves that existed before the batch, and ApplyCurves() replaces a curve computed twice.
+
+	TArray<TArray<FHumanComputedCurve>> ComputedCurves;
+	TArray<int32> NumRemovedKeys;
+	ComputedCurves.SetNum(Sequences.Num());
+	NumRemovedKeys.SetNumZeroed(Sequences.Num());
+
+	ParallelFor(Sequences.Num(), [&](int32 Index)
+	{
+		for (const auto* Modifier : Modifiers)
+		{
+			NumRemovedKeys[Index] += Modifier->Compute(Infos[Index], ComputedCurves[Index]);
+		}
+	});
+
+	for (auto i{ 0 }; i < Sequences.Num(); i++)
+	{
+		if (NumRemovedKeys[i] > 0)
+		{
+			UE_LOG(LogApplyHumanCurveModifiers, Log, TEXT("%s: Removed %d redundant keys (%d bytes)"),
+				*Sequences[i]->GetName(), NumRemovedKeys[i], NumRemovedKeys[i] * static_cast<int32>(sizeof(FRichCurveKey)));
+		}
+	}
+
+	// Write to the sequences on the game thread in a single transaction
+
+	{
+		FScopedTransaction Transaction(FText::Format(LOCTEXT("ApplyBatch", "Apply Human Curve Modifiers to {0} Sequences"), Sequences.Num()));
+
+		for (auto i{ 0 }; i < Sequences.Num(); i++)
+		{
+			Sequences[i]->Modify();
+
+			UAnimationModifier_HumanCurvesBase::ApplyCurves(Sequences[i], ComputedCurves[i]);
+		}
+	}
+
+	// Save
+
+	for (auto* Sequence : Sequences)
+	{
+		auto* Package{ Sequence->GetPackage() };
+
+		if (!Package->IsDirty())
+		{
+			OutSavedPackages.Add(Package->GetFName());
+			continue;
+		}
+
+		const auto Filename{ FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension()) };
+
+		FSavePackageArgs SaveArgs;
+		SaveArgs.TopLevelFlags = RF_Standalone;
+		SaveArgs.Error = GError;
+
+		if (UPackage::SavePackage(Package, nullptr, *Filename, SaveArgs))
+		{
+			OutSavedPackages.Add(Package->GetFName());
+		}
+		else
+		{
+			UE_LOG(LogApplyHumanCurveModifiers, Error, TEXT("Failed to save %s"), *Filename);
+			NumFailed++;
+		}
+	}
+
+	return NumFailed;
+}
+
+#undef LOCTEXT_NAMESPACE
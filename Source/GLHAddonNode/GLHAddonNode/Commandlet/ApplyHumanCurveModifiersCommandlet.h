@@ -0,0 +1,44 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "HumanCurveCommandletBase.h"
+
+#include "ApplyHumanCurveModifiersCommandlet.generated.h"
+
+class UAnimationModifier_HumanCurvesBase;
+
+
+/**
+ * Commandlet that applies the human curve modifiers to all animation sequences that match the filter
+ * 
+ * Usage:
+ *	UnrealEditor-Cmd <Project> -run=ApplyHumanCurveModifiers -Paths=/Game/Animations -unattended -nullrhi
+ * 
+ * Params:
+ *	-Paths=		Package paths to search, separated by '+' (Default: /Game)
+ *	-Skeleton=	Object path of the skeleton that the sequences must use
+ *	-Modifiers=	Modifier classes to apply in order, separated by '+' (Default: all UAnimationModifier_HumanCurvesBase classes applied by default)
+ *	-Manifest=	File that records the hashes of the processed packages (Default: Saved/HumanCurveModifiers.manifest)
+ *	-BatchSize=	Number of sequences loaded, computed and saved at once (Default: 256)
+ *	-Force		Process all sequences regardless of the manifest
+ * 
+ * Tips:
+ *	Curves are computed in parallel on the worker threads and written to the sequences on the game thread.
+ *	Each batch is applied in a single transaction and saved before the next batch is loaded.
+ */
+UCLASS()
+class UApplyHumanCurveModifiersCommandlet : public UHumanCurveCommandletBase
+{
+	GENERATED_BODY()
+public:
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	void GatherModifiers(const TArray<FString>& ClassNames, TArray<const UAnimationModifier_HumanCurvesBase*>& OutModifiers) const;
+
+	FString ComputeModifiersHash(const TArray<const UAnimationModifier_HumanCurvesBase*>& Modifiers) const;
+
+	int32 ProcessBatch(TConstArrayView<FAssetData> Assets, const TArray<const UAnimationModifier_HumanCurvesBase*>& Modifiers, TArray<FName>& OutSavedPackages) const;
+
+};
@@ -0,0 +1,134 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanCurveCommandletBase.h"
+
+#include "Animation/AnimSequence.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Async/ParallelFor.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/SecureHash.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanCurveCommandletBase)
+
+
+UHumanCurveCommandletBase::UHumanCurveCommandletBase()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+
+void UHumanCurveCommandletBase::GatherSequences(const TArray<FString>& Paths, const FString& SkeletonPath, TArray<FAssetData>& OutAssets) const
+{
+	auto& AssetRegistry{ FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get() };
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.ClassPaths.Add(UAnimSequence::StaticClass()->GetClassPathName());
+	Filter.bRecursiveClasses = true;
+	Filter.bRecursivePaths = true;
+
+	for (const auto& Path : Paths)
+	{
+		Filter.PackagePaths.Add(*Path);
+	}
+
+	AssetRegistry.GetAssets(Filter, OutAssets);
+
+	// Skeleton is compared with the asset registry tag so that the sequences do not have to be loaded.
+
+	if (!SkeletonPath.IsEmpty())
+	{
+		const FSoftObjectPath Skeleton{ SkeletonPath };
+
+		OutAssets.RemoveAllSwap([&Skeleton](const FAssetData& Asset)
+		{
+			const auto Tag{ Asset.GetTagValueRef<FString>(TEXT("Skeleton")) };
+
+			return FSoftObjectPath(FPackageName::ExportTextPathToObjectPath(Tag)) != Skeleton;
+		});
+	}
+}
+
+FString UHumanCurveCommandletBase::ComputePackageHash(const FName& PackageName, const FString& Salt) const
+{
+	FString Filename;
+
+	if (!FPackageName::DoesPackageExist(PackageName.ToString(), &Filename))
+	{
+		return FString();
+	}
+
+	return LexToString(FMD5Hash::HashFile(*Filename)) + Salt;
+}
+
+void UHumanCurveCommandletBase::RemoveUpToDateAssets(const TMap<FName, FString>& Manifest, const FString& Salt, TArray<FAssetData>& InOutAssets) const
+{
+	if (Manifest.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<bool> UpToDate;
+	UpToDate.SetNumZeroed(InOutAssets.Num());
+
+	ParallelFor(InOutAssets.Num(), [&](int32 Index)
+	{
+		const auto& PackageName{ InOutAssets[Index].PackageName };
+		const auto* RecordedHash{ Manifest.Find(PackageName) };
+
+		UpToDate[Index] = RecordedHash && (*RecordedHash == ComputePackageHash(PackageName, Salt));
+	});
+
+	auto NumPending{ 0 };
+
+	for (auto i{ 0 }; i < InOutAssets.Num(); i++)
+	{
+		if (!UpToDate[i])
+		{
+			InOutAssets.Swap(NumPending++, i);
+		}
+	}
+
+	InOutAssets.SetNum(NumPending);
+}
+
+void UHumanCurveCommandletBase::LoadManifest(const FString& Filename, TMap<FName, FString>& OutManifest) const
+{
+	TArray<FString> Lines;
+
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+	{
+		return;
+	}
+
+	for (const auto& Line : Lines)
+	{
+		FString PackageName, Hash;
+
+		if (Line.Split(TEXT(" "), &PackageName, &Hash))
+		{
+			OutManifest.Add(*PackageName, Hash);
+		}
+	}
+}
+
+void UHumanCurveCommandletBase::SaveManifest(const FString& Filename, const TMap<FName, FString>& Manifest) const
+{
+	TArray<FString> Lines;
+	Lines.Reserve(Manifest.Num());
+
+	for (const auto& KVP : Manifest)
+	{
+		Lines.Add(KVP.Key.ToString() + TEXT(" ") + KVP.Value);
+	}
+
+	Lines.Sort();
+
+	FFileHelper::SaveStringArrayToFile(Lines, *Filename);
+}
@@ -0,0 +1,43 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+
+#include "HumanCurveCommandletBase.generated.h"
+
+struct FAssetData;
+
+
+/**
+ * Base commandlet for the commandlets that process the human curves of animation sequences
+ * 
+ * Tips:
+ *	Provides the discovery of sequences and the manifest that records the content hashes of the processed packages
+ *	so that unchanged packages can be skipped in the next run.
+ */
+UCLASS(Abstract)
+class UHumanCurveCommandletBase : public UCommandlet
+{
+	GENERATED_BODY()
+public:
+	UHumanCurveCommandletBase();
+
+protected:
+	void GatherSequences(const TArray<FString>& Paths, const FString& SkeletonPath, TArray<FAssetData>& OutAssets) const;
+
+	/**
+	 * Returns the hash of the package file combined with the Salt, or an empty string if the package does not exist
+	 */
+	FString ComputePackageHash(const FName& PackageName, const FString& Salt) const;
+
+	/**
+	 * Computes the hashes of the packages in parallel and removes the assets whose hash matches the manifest
+	 */
+	void RemoveUpToDateAssets(const TMap<FName, FString>& Manifest, const FString& Salt, TArray<FAssetData>& InOutAssets) const;
+
+	void LoadManifest(const FString& Filename, TMap<FName, FString>& OutManifest) const;
+
+	void SaveManifest(const FString& Filename, const TMap<FName, FString>& Manifest) const;
+
+};
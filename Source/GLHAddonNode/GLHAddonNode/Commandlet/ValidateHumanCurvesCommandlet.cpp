@@ -0,0 +1,378 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "ValidateHumanCurvesCommandlet.h"
+
+#include "HumanAnimInstance.h"
+#include "HumanLinkedAnimInstance.h"
+#include "LocomotionHumanNameStatics.h"
+
+#include "LocomotionGeneralNameStatics.h"
+
+#include "Animation/AnimBlueprint.h"
+#include "Animation/AnimSequence.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Blueprint.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(ValidateHumanCurvesCommandlet)
+
+DEFINE_LOG_CATEGORY_STATIC(LogValidateHumanCurves, Log, All);
+
+
+int32 UValidateHumanCurvesCommandlet::Main(const FString& Params)
+{
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	const auto ParseList
+	{
+		[&ParamValues](const TCHAR* Key)
+		{
+			TArray<FString> Values;
+			ParamValues.FindRef(Key).ParseIntoArray(Values, TEXT("+"));
+			return Values;
+		}
+	};
+
+	const auto Paths{ ParseList(TEXT("Paths")) };
+	const auto GroupNames{ ParseList(TEXT("Groups")) };
+	const auto SkeletonPath{ ParamValues.FindRef(TEXT("Skeleton")) };
+	const auto* BatchSizeValue{ ParamValues.Find(TEXT("BatchSize")) };
+	const auto BatchSize{ BatchSizeValue ? FMath::Max(1, FCString::Atoi(**BatchSizeValue)) : 256 };
+	const auto bForce{ Switches.Contains(TEXT("Force")) };
+
+	auto ManifestFilename{ ParamValues.FindRef(TEXT("Manifest")) };
+
+	if (ManifestFilename.IsEmpty())
+	{
+		ManifestFilename = FPaths::ProjectSavedDir() / TEXT("HumanCurveValidation.manifest");
+	}
+
+	// Rules
+
+	TArray<FHumanCurveRule> Rules;
+	GatherRules(GroupNames, Rules);
+
+	if (Rules.IsEmpty())
+	{
+		UE_LOG(LogValidateHumanCurves, Error, TEXT("No human curve to validate"));
+		return 1;
+	}
+
+	// Sequences
+
+	TArray<FAssetData> Assets;
+
+	if (Paths.IsEmpty())
+	{
+		GatherReferencedSequences(SkeletonPath, Assets);
+	}
+	else
+	{
+		GatherSequences(Paths, SkeletonPath, Assets);
+	}
+
+	UE_LOG(LogValidateHumanCurves, Display, TEXT("Found %d sequences, %d curves"), Assets.Num(), Rules.Num());
+
+	// Skip the packages that were valid with the same content and rules. The package files are hashed in parallel.
+
+	TMap<FName, FString> Manifest;
+
+	if (!bForce)
+	{
+		LoadManifest(ManifestFilename, Manifest);
+	}
+
+	const auto RulesHash{ ComputeRulesHash(Rules) };
+
+	auto PendingAssets{ Assets };
+	RemoveUpToDateAssets(Manifest, RulesHash, PendingAssets);
+
+	UE_LOG(LogValidateHumanCurves, Display, TEXT("%d sequences are up to date, %d to validate"), Assets.Num() - PendingAssets.Num(), PendingAssets.Num());
+
+	// Validate in batches so that the memory is bounded
+
+	auto NumInvalid{ 0 };
+
+	for (auto Start{ 0 }; Start < PendingAssets.Num(); Start += BatchSize)
+	{
+		const auto Batch{ TConstArrayView<FAssetData>(PendingAssets).Mid(Start, BatchSize) };
+
+		TArray<FName> ValidPackages;
+		NumInvalid += ValidateBatch(Batch, Rules, ValidPackages);
+
+		for (const auto& PackageName : ValidPackages)
+		{
+			Manifest.Add(PackageName, ComputePackageHash(PackageName, RulesHash));
+		}
+
+		for (const auto& Asset : Batch)
+		{
+			if (!ValidPackages.Contains(Asset.PackageName))
+			{
+				Manifest.Remove(Asset.PackageName);
+			}
+		}
+
+		SaveManifest(ManifestFilename, Manifest);
+
+		CollectGarbage(RF_NoFlags);
+
+		UE_LOG(LogValidateHumanCurves, Display, TEXT("Validated %d / %d"), FMath::Min(Start + BatchSize, PendingAssets.Num()), PendingAssets.Num());
+	}
+
+	UE_LOG(LogValidateHumanCurves, Display, TEXT("Finished (%d invalid)"), NumInvalid);
+
+	return (NumInvalid > 0) ? 1 : 0;
+}
+
+
+void UValidateHumanCurvesCommandlet::GatherReferencedSequences(const FString& SkeletonPath, TArray<FAssetData>& OutAssets) const
+{
+	auto& AssetRegistry{ FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get() };
+	AssetRegistry.SearchAllAssets(true);
+
+	// Anim blueprints are filtered by the native parent class tag so that the blueprints do not have to be loaded.
+
+	TArray<FAssetData> Blueprints;
+	AssetRegistry.GetAssetsByClass(UAnimBlueprint::StaticClass()->GetClassPathName(), Blueprints, true);
+
+	TArray<FName> PendingPackages;
+	TSet<FName> VisitedPackages;
+
+	for (const auto& Blueprint : Blueprints)
+	{
+		const auto Tag{ Blueprint.GetTagValueRef<FString>(FBlueprintTags::NativeParentClassPath) };
+		const auto* NativeParentClass{ FSoftClassPath(FPackageName::ExportTextPathToObjectPath(Tag)).ResolveClass() };
+
+		if (NativeParentClass && (NativeParentClass->IsChildOf<UHumanAnimInstance>() || NativeParentClass->IsChildOf<UHumanLinkedAnimInstance>()))
+		{
+			PendingPackages.Add(Blueprint.PackageName);
+			VisitedPackages.Add(Blueprint.PackageName);
+		}
+	}
+
+	// Follow both the hard and the soft references through the animation assets such as blend spaces and montages,
+	// since the transition animations of the anim instances are soft references
+
+	TArray<FName> Dependencies;
+	TArray<FAssetData> PackageAssets;
+	TSet<FSoftObjectPath> FoundSequences;
+
+	while (!PendingPackages.IsEmpty())
+	{
+		const auto PackageName{ PendingPackages.Pop() };
+
+		Dependencies.Reset();
+		AssetRegistry.GetDependencies(PackageName, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::NoRequirements);
+
+		for (const auto& Dependency : Dependencies)
+		{
+			if (VisitedPackages.Contains(Dependency) || FPackageName::IsScriptPackage(Dependency.ToString()))
+			{
+				continue;
+			}
+
+			VisitedPackages.Add(Dependency);
+
+			PackageAssets.Reset();
+			AssetRegistry.GetAssetsByPackageName(Dependency, PackageAssets);
+
+			for (const auto& Asset : PackageAssets)
+			{
+				if (Asset.IsInstanceOf<UAnimSequence>())
+				{
+					if (!FoundSequences.Contains(Asset.GetSoftObjectPath()))
+					{
+						FoundSequences.Add(Asset.GetSoftObjectPath());
+						OutAssets.Add(Asset);
+					}
+				}
+				else if (Asset.IsInstanceOf<UAnimationAsset>() || Asset.IsInstanceOf<UAnimBlueprint>())
+				{
+					PendingPackages.Add(Dependency);
+				}
+			}
+		}
+	}
+
+	if (!SkeletonPath.IsEmpty())
+	{
+		const FSoftObjectPath Skeleton{ SkeletonPath };
+
+		OutAssets.RemoveAllSwap([&Skeleton](const FAssetData& Asset)
+		{
+			const auto Tag{ Asset.GetTagValueRef<FString>(TEXT("Skeleton")) };
+
+			return FSoftObjectPath(FPackageName::ExportTextPathToObjectPath(Tag)) != Skeleton;
+		});
+	}
+}
+
+void UValidateHumanCurvesCommandlet::GatherRules(const TArray<FString>& GroupNames, TArray<FHumanCurveRule>& OutRules) const
+{
+	const auto ShouldValidate
+	{
+		[&GroupNames](const TCHAR* GroupName)
+		{
+			return GroupNames.IsEmpty() || GroupNames.Contains(GroupName);
+		}
+	};
+
+	if (ShouldValidate(TEXT("Pose")))
+	{
+		OutRules.Emplace(ULocomotionHumanNameStatics::PoseGaitCurveName(), 0.0f, 3.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::PoseMovingCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::PoseStandingCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::PoseCrouchingCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::PoseGroundedCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::PoseInAirCurveName(), 0.0f, 1.0f);
+	}
+
+	if (ShouldValidate(TEXT("Feet")))
+	{
+		OutRules.Emplace(ULocomotionHumanNameStatics::FootLeftIkCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::FootLeftLockCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::FootRightIkCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::FootRightLockCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::FootPlantedCurveName(), -1.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::FeetCrossingCurveName(), 0.0f, 1.0f);
+	}
+
+	if (ShouldValidate(TEXT("Layering")))
+	{
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerHeadCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerHeadAdditiveCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerHeadSlotCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmLeftCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmLeftAdditiveCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmLeftLocalSpaceCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmLeftSlotCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmRightCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmRightAdditiveCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmRightLocalSpaceCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerArmRightSlotCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerHandLeftCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerHandRightCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerSpineCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerSpineAdditiveCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerSpineSlotCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerPelvisCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerPelvisSlotCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerLegsCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::LayerLegsSlotCurveName(), 0.0f, 1.0f);
+	}
+
+	if (ShouldValidate(TEXT("Ground")))
+	{
+		OutRules.Emplace(ULocomotionHumanNameStatics::SprintBlockCurveName(), 0.0f, 1.0f);
+		OutRules.Emplace(ULocomotionHumanNameStatics::HipsDirectionLockCurveName(), -1.0f, 1.0f);
+		OutRules.Emplace(ULocomotionGeneralNameStatics::GroundPredictionBlockCurveName(), 0.0f, 1.0f);
+	}
+
+	if (ShouldValidate(TEXT("Transitions")))
+	{
+		OutRules.Emplace(ULocomotionGeneralNameStatics::AllowTransitionsCurveName(), 0.0f, 1.0f);
+	}
+}
+
+FString UValidateHumanCurvesCommandlet::ComputeRulesHash(const TArray<FHumanCurveRule>& Rules) const
+{
+	FString Text;
+
+	for (const auto& Rule : Rules)
+	{
+		Text += FString::Printf(TEXT("%s[%g,%g];"), *Rule.CurveName.ToString(), Rule.MinValue, Rule.MaxValue);
+	}
+
+	return FMD5::HashAnsiString(*Text);
+}
+
+int32 UValidateHumanCurvesCommandlet::ValidateBatch(TConstArrayView<FAssetData> Assets, const TArray<FHumanCurveRule>& Rules, TArray<FName>& OutValidPackages) const
+{
+	auto NumInvalid{ 0 };
+
+	// Load the sequences on the game thread
+
+	TArray<const UAnimSequence*> Sequences;
+	TArray<const TArray<FFloatCurve>*> FloatCurves;
+	Sequences.Reserve(Assets.Num());
+	FloatCurves.Reserve(Assets.Num());
+
+	for (const auto& Asset : Assets)
+	{
+		if (const auto* Sequence{ Cast<UAnimSequence>(Asset.GetAsset()) })
+		{
+			Sequences.Add(Sequence);
+			FloatCurves.Add(&Sequence->GetDataModel()->GetFloatCurves());
+		}
+		else
+		{
+			UE_LOG(LogValidateHumanCurves, Error, TEXT("Failed to load %s"), *Asset.GetObjectPathString());
+			NumInvalid++;
+		}
+	}
+
+	// Validate the curves on the worker threads. Nothing modifies the sequences until the errors are collected.
+
+	TArray<TArray<FString>> Errors;
+	Errors.SetNum(Sequences.Num());
+
+	ParallelFor(Sequences.Num(), [&](int32 Index)
+	{
+		for (const auto& Rule : Rules)
+		{
+			const auto* FloatCurve
+			{
+				FloatCurves[Index]->FindByPredicate([&Rule](const FFloatCurve& Curve)
+				{
+					return Curve.GetName() == Rule.CurveName;
+				})
+			};
+
+			if (!FloatCurve)
+			{
+				Errors[Index].Add(FString::Printf(TEXT("Missing curve %s"), *Rule.CurveName.ToString()));
+				continue;
+			}
+
+			auto MinValue{ FloatCurve->FloatCurve.Eval(0.0f) };
+			auto MaxValue{ MinValue };
+
+			if (FloatCurve->FloatCurve.GetNumKeys() > 0)
+			{
+				FloatCurve->FloatCurve.GetValueRange(MinValue, MaxValue);
+			}
+
+			if ((MinValue < Rule.MinValue - UE_KINDA_SMALL_NUMBER) || (MaxValue > Rule.MaxValue + UE_KINDA_SMALL_NUMBER))
+			{
+				Errors[Index].Add(FString::Printf(TEXT("Curve %s is in [%g, %g] but must be in [%g, %g]"),
+					*Rule.CurveName.ToString(), MinValue, MaxValue, Rule.MinValue, Rule.MaxValue));
+			}
+		}
+	});
+
+	for (auto i{ 0 }; i < Sequences.Num(); i++)
+	{
+		if (Errors[i].IsEmpty())
+		{
+			OutValidPackages.Add(Sequences[i]->GetPackage()->GetFName());
+			continue;
+		}
+
+		for (const auto& Error : Errors[i])
+		{
+			UE_LOG(LogValidateHumanCurves, Error, TEXT("%s: %s"), *Sequences[i]->GetPathName(), *Error);
+		}
+
+		NumInvalid++;
+	}
+
+	return NumInvalid;
+}
@@ -0,0 +1,68 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "HumanCurveCommandletBase.h"
+
+#include "ValidateHumanCurvesCommandlet.generated.h"
+
+
+/**
+ * Curve that the sequences must have and the range that its keys must be within
+ */
+struct FHumanCurveRule
+{
+public:
+	FHumanCurveRule(const FName& InCurveName, float InMinValue, float InMaxValue)
+		: CurveName(InCurveName), MinValue(InMinValue), MaxValue(InMaxValue)
+	{}
+
+public:
+	FName CurveName;
+
+	float MinValue{ 0.0f };
+
+	float MaxValue{ 1.0f };
+
+};
+
+
+/**
+ * Commandlet that validates that the animation sequences have the curves read by UHumanAnimInstance within sane ranges
+ * 
+ * Usage:
+ *	UnrealEditor-Cmd <Project> -run=ValidateHumanCurves -unattended -nullrhi
+ * 
+ * Params:
+ *	-Paths=		Package paths to search, separated by '+' (Default: sequences referenced by the human anim blueprints)
+ *	-Skeleton=	Object path of the skeleton that the sequences must use
+ *	-Groups=	Curve groups to validate, separated by '+' [Pose, Feet, Layering, Ground, Transitions] (Default: all)
+ *	-Manifest=	File that records the hashes of the valid packages (Default: Saved/HumanCurveValidation.manifest)
+ *	-BatchSize=	Number of sequences loaded and validated at once (Default: 256)
+ *	-Force		Validate all sequences regardless of the manifest
+ * 
+ * Tips:
+ *	Returns non-zero if any sequence is invalid so that it can be used as a CI step.
+ *	Only valid packages are recorded in the manifest, so invalid sequences are reported again until they are fixed.
+ */
+UCLASS()
+class UValidateHumanCurvesCommandlet : public UHumanCurveCommandletBase
+{
+	GENERATED_BODY()
+public:
+	virtual int32 Main(const FString& Params) override;
+
+protected:
+	/**
+	 * Gathers the sequences referenced directly or through other animation assets by the anim blueprints
+	 * whose native parent class is UHumanAnimInstance or UHumanLinkedAnimInstance
+	 */
+	void GatherReferencedSequences(const FString& SkeletonPath, TArray<FAssetData>& OutAssets) const;
+
+	void GatherRules(const TArray<FString>& GroupNames, TArray<FHumanCurveRule>& OutRules) const;
+
+	FString ComputeRulesHash(const TArray<FHumanCurveRule>& Rules) const;
+
+	int32 ValidateBatch(TConstArrayView<FAssetData> Assets, const TArray<FHumanCurveRule>& Rules, TArray<FName>& OutValidPackages) const;
+
+};
@@ -6,9 +6,6 @@
 
 #include "LocomotionGeneralNameStatics.h"
 
-#include "AnimationBlueprintLibrary.h"
-#include "Animation/AnimSequence.h"
-
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AnimationModifier_CreateHumanCurves)
 
 
@@ -38,36 +35,38 @@ UAnimationModifier_CreateHumanCurves::UAnimationModifier_CreateHumanCurves()
 }
 
 
-void UAnimationModifier_CreateHumanCurves::OnApply_Implementation(UAnimSequence* Sequence)
+void UAnimationModifier_CreateHumanCurves::ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const
 {
-	Super::OnApply_Implementation(Sequence);
-
 	for (const auto& Curve : Curves)
 	{
-		if (UAnimationBlueprintLibrary::DoesCurveExist(Sequence, Curve.Name, ERawCurveTrackTypes::RCT_Float))
+		if (!bOverrideExistingCurves && Info.DoesCurveExist(Curve.Name))
 		{
-			if (!bOverrideExistingCurves)
-			{
-				continue;
-			}
-
-			UAnimationBlueprintLibrary::RemoveCurve(Sequence, Curve.Name);
+			continue;
 		}
 
-		UAnimationBlueprintLibrary::AddCurve(Sequence, Curve.Name);
+		auto& ComputedCurve{ OutCurves.AddDefaulted_GetRef() };
+		ComputedCurve.Name = Curve.Name;
 
 		if (Curve.bAddKeyOnEachFrame)
 		{
-			for (auto i{ 0 }; i < Sequence->GetNumberOfSampledKeys(); i++)
+			ComputedCurve.Times.Reserve(Info.NumSampledKeys);
+			ComputedCurve.Values.Reserve(Info.NumSampledKeys);
+
+			for (auto i{ 0 }; i < Info.NumSampledKeys; i++)
 			{
-				UAnimationBlueprintLibrary::AddFloatCurveKey(Sequence, Curve.Name, Sequence->GetTimeAtFrame(i), 0);
+				ComputedCurve.Times.Add(Info.GetTimeAtFrame(i));
+				ComputedCurve.Values.Add(0.0f);
 			}
 		}
 		else
 		{
+			ComputedCurve.Times.Reserve(Curve.Keys.Num());
+			ComputedCurve.Values.Reserve(Curve.Keys.Num());
+
 			for (const auto& CurveKey : Curve.Keys)
 			{
-				UAnimationBlueprintLibrary::AddFloatCurveKey(Sequence, Curve.Name, Sequence->GetTimeAtFrame(CurveKey.Frame), CurveKey.Value);
+				ComputedCurve.Times.Add(Info.GetTimeAtFrame(CurveKey.Frame));
+				ComputedCurve.Values.Add(CurveKey.Value);
 			}
 		}
 	}
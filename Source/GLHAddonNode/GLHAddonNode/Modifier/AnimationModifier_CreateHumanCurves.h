@@ -2,7 +2,7 @@
 
 #pragma once
 
-#include "AnimationModifier.h"
+#include "AnimationModifier_HumanCurvesBase.h"
 
 #include "AnimationModifier_CreateHumanCurves.generated.h"
 
@@ -50,7 +50,7 @@ public:
  * Curve data to be added
  */
 UCLASS(DisplayName = "AM Create Curves For Human")
-class GLHADDONNODE_API UAnimationModifier_CreateHumanCurves : public UAnimationModifier
+class GLHADDONNODE_API UAnimationModifier_CreateHumanCurves : public UAnimationModifier_HumanCurvesBase
 {
 	GENERATED_BODY()
 public:
@@ -64,6 +64,6 @@ protected:
 	TArray<FAnimationCurve> Curves;
 
 public:
-	virtual void OnApply_Implementation(UAnimSequence* Sequence) override;
+	virtual void ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const override;
 
 };
@@ -0,0 +1,82 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimationModifier_CreateHumanDistanceCurves.h"
+
+#include "LocomotionHumanNameStatics.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimationModifier_CreateHumanDistanceCurves)
+
+
+void UAnimationModifier_CreateHumanDistanceCurves::GetRequiredBones(TArray<FName>& OutBoneNames) const
+{
+	if (!SourceBoneName.IsNone())
+	{
+		OutBoneNames.AddUnique(SourceBoneName);
+	}
+}
+
+void UAnimationModifier_CreateHumanDistanceCurves::ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const
+{
+	const auto& CurveName{ ULocomotionHumanNameStatics::DistanceToMarkerCurveName() };
+
+	if ((Info.NumSampledKeys < 2) || (!bOverrideExistingCurves && Info.DoesCurveExist(CurveName)))
+	{
+		return;
+	}
+
+	const auto bUseRootBone{ SourceBoneName.IsNone() };
+
+	if (!bUseRootBone && !Info.HasBone(SourceBoneName))
+	{
+		return;
+	}
+
+	// Travel of the source between each frame and the next
+
+	const auto NumFrames{ Info.NumSampledKeys };
+
+	TArray<float> Steps;
+	Steps.SetNumUninitialized(NumFrames - 1);
+
+	auto PreviousLocation{ bUseRootBone ? Info.GetRootBoneTransform(0).GetLocation() : Info.GetComponentSpaceBoneTransform(SourceBoneName, 0).GetLocation() };
+	auto MarkerFrame{ 0 };
+
+	for (auto Frame{ 1 }; Frame < NumFrames; Frame++)
+	{
+		const auto Location{ bUseRootBone ? Info.GetRootBoneTransform(Frame).GetLocation() : Info.GetComponentSpaceBoneTransform(SourceBoneName, Frame).GetLocation() };
+		const auto Delta{ Location - PreviousLocation };
+
+		Steps[Frame - 1] = UE_REAL_TO_FLOAT(bIgnoreVerticalTravel ? Delta.Size2D() : Delta.Size());
+		PreviousLocation = Location;
+
+		const auto DeltaTime{ Info.GetTimeAtFrame(Frame) - Info.GetTimeAtFrame(Frame - 1) };
+
+		if ((DeltaTime > UE_SMALL_NUMBER) && (Steps[Frame - 1] / DeltaTime >= MarkerSpeedThreshold))
+		{
+			MarkerFrame = Frame;
+		}
+	}
+
+	// Remaining travel until the marker, accumulated backward. It stays zero after the marker.
+
+	TArray<float> Distances;
+	Distances.SetNumZeroed(NumFrames);
+
+	for (auto Frame{ MarkerFrame - 1 }; Frame >= 0; Frame--)
+	{
+		Distances[Frame] = Distances[Frame + 1] + Steps[Frame];
+	}
+
+	auto& ComputedCurve{ OutCurves.AddDefaulted_GetRef() };
+	ComputedCurve.Name = CurveName;
+	ComputedCurve.Times.Reserve(NumFrames);
+	ComputedCurve.Values.Reserve(NumFrames);
+
+	// A key on every frame, which is reduced afterwards
+
+	for (auto Frame{ 0 }; Frame < NumFrames; Frame++)
+	{
+		ComputedCurve.Times.Add(Info.GetTimeAtFrame(Frame));
+		ComputedCurve.Values.Add(Distances[Frame]);
+	}
+}
@@ -0,0 +1,55 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimationModifier_HumanCurvesBase.h"
+
+#include "AnimationModifier_CreateHumanDistanceCurves.generated.h"
+
+
+/**
+ * Modifier that creates the distance to marker curve from the remaining travel of the root or a bone until it stops
+ * 
+ * Tips:
+ *	Use the root bone for stops with root motion and the stepping foot for in-place stops and transitions.
+ *	The curve is inverted into the distance lookup table of UHumanCurveSummaryUserData, which UHumanAnimInstance uses for distance matching.
+ */
+UCLASS(DisplayName = "AM Create Distance Curves For Human")
+class GLHADDONNODE_API UAnimationModifier_CreateHumanDistanceCurves : public UAnimationModifier_HumanCurvesBase
+{
+	GENERATED_BODY()
+public:
+	UAnimationModifier_CreateHumanDistanceCurves() {}
+
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings")
+	bool bOverrideExistingCurves{ true };
+
+	//
+	// Bone whose travel is measured in component space. The root bone is used if it is none.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Bones")
+	FName SourceBoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Bones")
+	bool bIgnoreVerticalTravel{ true };
+
+	//
+	// Speed of the source below which it is considered stopped.
+	// The marker is placed where the source stops for the last time.
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Marker", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float MarkerSpeedThreshold{ 5.0f };
+
+public:
+	virtual void GetRequiredBones(TArray<FName>& OutBoneNames) const override;
+
+	/**
+	 * Only stops and transitions have a marker, so it must be applied to them explicitly
+	 */
+	virtual bool IsAppliedByDefault() const override { return false; }
+
+protected:
+	virtual void ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const override;
+
+};
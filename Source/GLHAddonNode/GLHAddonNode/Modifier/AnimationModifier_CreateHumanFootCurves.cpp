@@ -0,0 +1,200 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimationModifier_CreateHumanFootCurves.h"
+
+#include "LocomotionHumanNameStatics.h"
+
+#include "Async/ParallelFor.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimationModifier_CreateHumanFootCurves)
+
+
+UAnimationModifier_CreateHumanFootCurves::UAnimationModifier_CreateHumanFootCurves()
+{
+	FootLeftBoneName = ULocomotionHumanNameStatics::FootLeftBoneName();
+	FootRightBoneName = ULocomotionHumanNameStatics::FootRightBoneName();
+}
+
+
+void UAnimationModifier_CreateHumanFootCurves::GetRequiredBones(TArray<FName>& OutBoneNames) const
+{
+	OutBoneNames.AddUnique(FootLeftBoneName);
+	OutBoneNames.AddUnique(FootRightBoneName);
+}
+
+void UAnimationModifier_CreateHumanFootCurves::ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const
+{
+	TArray<FVector> LeftLocations;
+	TArray<FVector> RightLocations;
+
+	if ((Info.NumSampledKeys < 2) || !SampleFeetLocations(Info, FootLeftBoneName, FootRightBoneName, LeftLocations, RightLocations))
+	{
+		return;
+	}
+
+	const auto GroundVelocity{ EstimateGroundVelocity(Info, LeftLocations, RightLocations) };
+
+	TArray<bool> LeftPlanted;
+	TArray<bool> RightPlanted;
+	DetectPlantedFrames(Info, LeftLocations, GroundVelocity, LeftPlanted);
+	DetectPlantedFrames(Info, RightLocations, GroundVelocity, RightPlanted);
+
+	// Curves
+
+	if (bCreateFootLockCurves)
+	{
+		AddCurve(Info, ULocomotionHumanNameStatics::FootLeftLockCurveName(), [&LeftPlanted](int32 Frame) { return LeftPlanted[Frame] ? 1.0f : 0.0f; }, OutCurves);
+		AddCurve(Info, ULocomotionHumanNameStatics::FootRightLockCurveName(), [&RightPlanted](int32 Frame) { return RightPlanted[Frame] ? 1.0f : 0.0f; }, OutCurves);
+	}
+
+	if (bCreateFootPlantedCurve)
+	{
+		AddCurve(Info, ULocomotionHumanNameStatics::FootPlantedCurveName(), [&LeftPlanted, &RightPlanted](int32 Frame)
+		{
+			return (RightPlanted[Frame] ? 1.0f : 0.0f) - (LeftPlanted[Frame] ? 1.0f : 0.0f);
+		}, OutCurves);
+	}
+
+	if (bCreateFeetCrossingCurve)
+	{
+		const auto Direction{ LeftDirection.GetSafeNormal() };
+
+		AddCurve(Info, ULocomotionHumanNameStatics::FeetCrossingCurveName(), [&, Direction](int32 Frame)
+		{
+			return FMath::Clamp(static_cast<float>((RightLocations[Frame] - LeftLocations[Frame]) | Direction) / FeetCrossingBlendDistance, 0.0f, 1.0f);
+		}, OutCurves);
+	}
+}
+
+bool UAnimationModifier_CreateHumanFootCurves::SampleFeetLocations(const FHumanCurveSequenceInfo& Info, const FName& LeftBoneName, const FName& RightBoneName, TArray<FVector>& OutLeftLocations, TArray<FVector>& OutRightLocations)
+{
+	if (!Info.HasBone(LeftBoneName) || !Info.HasBone(RightBoneName))
+	{
+		return false;
+	}
+
+	// Relative to the root, so that the root motion does not count as the motion of the feet
+
+	const auto NumFrames{ Info.NumSampledKeys };
+
+	OutLeftLocations.SetNumUninitialized(NumFrames);
+	OutRightLocations.SetNumUninitialized(NumFrames);
+
+	ParallelFor(NumFrames, [&](int32 Frame)
+	{
+		const auto RootTransform{ Info.GetRootBoneTransform(Frame) };
+
+		OutLeftLocations[Frame] = RootTransform.InverseTransformPosition(Info.GetComponentSpaceBoneTransform(LeftBoneName, Frame).GetLocation());
+		OutRightLocations[Frame] = RootTransform.InverseTransformPosition(Info.GetComponentSpaceBoneTransform(RightBoneName, Frame).GetLocation());
+	});
+
+	return true;
+}
+
+FVector UAnimationModifier_CreateHumanFootCurves::EstimateGroundVelocity(const FHumanCurveSequenceInfo& Info, const TArray<FVector>& LeftLocations, const TArray<FVector>& RightLocations)
+{
+	const auto NumFrames{ LeftLocations.Num() };
+
+	if (NumFrames < 2)
+	{
+		return FVector::ZeroVector;
+	}
+
+	// The lower foot of each frame is assumed to be on the ground
+
+	const auto FrameTime{ static_cast<float>(Info.SamplingFrameRate.AsInterval()) };
+
+	auto GroundVelocity{ FVector::ZeroVector };
+
+	for (auto Frame{ 0 }; Frame < NumFrames - 1; Frame++)
+	{
+		const auto& Locations{ (LeftLocations[Frame].Z <= RightLocations[Frame].Z) ? LeftLocations : RightLocations };
+
+		GroundVelocity += (Locations[Frame + 1] - Locations[Frame]) / FrameTime;
+	}
+
+	GroundVelocity /= (NumFrames - 1);
+	GroundVelocity.Z = 0.0f;
+
+	return GroundVelocity;
+}
+
+void UAnimationModifier_CreateHumanFootCurves::DetectPlantedFrames(const FHumanCurveSequenceInfo& Info, const TArray<FVector>& Locations, const FVector& GroundVelocity, TArray<bool>& OutPlanted) const
+{
+	const auto NumFrames{ Locations.Num() };
+	const auto FrameTime{ static_cast<float>(Info.SamplingFrameRate.AsInterval()) };
+
+	auto MinHeight{ Locations[0].Z };
+
+	for (const auto& Location : Locations)
+	{
+		MinHeight = FMath::Min(MinHeight, Location.Z);
+	}
+
+	OutPlanted.SetNumUninitialized(NumFrames);
+
+	for (auto Frame{ 0 }; Frame < NumFrames; Frame++)
+	{
+		// Central difference except at both ends
+
+		const auto Previous{ FMath::Max(Frame - 1, 0) };
+		const auto Next{ FMath::Min(Frame + 1, NumFrames - 1) };
+
+		auto Velocity{ (Locations[Next] - Locations[Previous]) / ((Next - Previous) * FrameTime) };
+		Velocity.Z = 0.0f;
+
+		OutPlanted[Frame] = ((Locations[Frame].Z - MinHeight) <= PlantHeightThreshold) &&
+							((Velocity - GroundVelocity).SizeSquared() <= FMath::Square(PlantSpeedThreshold));
+	}
+
+	// Remove the plant phases that are too short to be locked
+
+	const auto MinPlantFrames{ FMath::CeilToInt32(MinPlantDuration / FrameTime) };
+
+	for (auto Start{ 0 }; Start < NumFrames;)
+	{
+		if (!OutPlanted[Start])
+		{
+			Start++;
+			continue;
+		}
+
+		auto End{ Start };
+
+		while ((End < NumFrames) && OutPlanted[End])
+		{
+			End++;
+		}
+
+		if ((End - Start) < MinPlantFrames)
+		{
+			for (auto Frame{ Start }; Frame < End; Frame++)
+			{
+				OutPlanted[Frame] = false;
+			}
+		}
+
+		Start = End;
+	}
+}
+
+void UAnimationModifier_CreateHumanFootCurves::AddCurve(const FHumanCurveSequenceInfo& Info, const FName& CurveName, TFunctionRef<float(int32)> ValueAtFrame, TArray<FHumanComputedCurve>& OutCurves) const
+{
+	if (!bOverrideExistingCurves && Info.DoesCurveExist(CurveName))
+	{
+		return;
+	}
+
+	auto& ComputedCurve{ OutCurves.AddDefaulted_GetRef() };
+	ComputedCurve.Name = CurveName;
+	ComputedCurve.Times.Reserve(Info.NumSampledKeys);
+	ComputedCurve.Values.Reserve(Info.NumSampledKeys);
+
+	// A key on every frame, which is reduced afterwards
+
+	for (auto Frame{ 0 }; Frame < Info.NumSampledKeys; Frame++)
+	{
+		ComputedCurve.Times.Add(Info.GetTimeAtFrame(Frame));
+		ComputedCurve.Values.Add(ValueAtFrame(Frame));
+	}
+}
@@ -0,0 +1,107 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimationModifier_HumanCurvesBase.h"
+
+#include "AnimationModifier_CreateHumanFootCurves.generated.h"
+
+
+/**
+ * Modifier that creates the foot lock, foot planted and feet crossing curves by analyzing the motion of the foot bones
+ * 
+ * Tips:
+ *	A foot is planted while it is near its lowest height and moves with the ground.
+ *	The ground velocity is estimated from the lower foot of each frame, so that both in-place and root motion sequences are supported.
+ */
+UCLASS(DisplayName = "AM Create Foot Curves For Human")
+class GLHADDONNODE_API UAnimationModifier_CreateHumanFootCurves : public UAnimationModifier_HumanCurvesBase
+{
+	GENERATED_BODY()
+public:
+	UAnimationModifier_CreateHumanFootCurves();
+
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings")
+	bool bOverrideExistingCurves{ true };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Bones")
+	FName FootLeftBoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Bones")
+	FName FootRightBoneName;
+
+	//
+	// Direction from the right foot to the left foot in component space when the feet are not crossed
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Bones")
+	FVector LeftDirection{ FVector::XAxisVector };
+
+	//
+	// Height above the lowest height of the foot in the sequence within which the foot can be planted
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Plant", Meta = (ClampMin = 0, ForceUnits = "cm"))
+	float PlantHeightThreshold{ 4.0f };
+
+	//
+	// Horizontal speed of the foot relative to the ground below which the foot can be planted
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Plant", Meta = (ClampMin = 0, ForceUnits = "cm/s"))
+	float PlantSpeedThreshold{ 20.0f };
+
+	//
+	// Plant phases shorter than this are ignored
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Plant", Meta = (ClampMin = 0, ForceUnits = "s"))
+	float MinPlantDuration{ 0.05f };
+
+	//
+	// Distance by which the right foot has to be on the left of the left foot for the feet crossing curve to be 1
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Crossing", Meta = (ClampMin = 0.01, ForceUnits = "cm"))
+	float FeetCrossingBlendDistance{ 5.0f };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Curves")
+	bool bCreateFootLockCurves{ true };
+
+	//
+	// Tips:
+	//	Positive while only the right foot is planted and negative while only the left foot is planted
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Curves")
+	bool bCreateFootPlantedCurve{ true };
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Curves")
+	bool bCreateFeetCrossingCurve{ true };
+
+public:
+	virtual void GetRequiredBones(TArray<FName>& OutBoneNames) const override;
+
+	/**
+	 * Sample the locations of the feet relative to the root bone for each frame in parallel
+	 * 
+	 * @return False if the feet are not found
+	 */
+	static bool SampleFeetLocations(const FHumanCurveSequenceInfo& Info, const FName& LeftBoneName, const FName& RightBoneName, TArray<FVector>& OutLeftLocations, TArray<FVector>& OutRightLocations);
+
+	/**
+	 * Estimate the horizontal velocity of the ground relative to the root bone from the lower foot of each frame
+	 * 
+	 * Tips:
+	 *	It is zero for idles and the inverse of the movement for cycles, including root motion cycles,
+	 *	because the feet are sampled relative to the root.
+	 */
+	static FVector EstimateGroundVelocity(const FHumanCurveSequenceInfo& Info, const TArray<FVector>& LeftLocations, const TArray<FVector>& RightLocations);
+
+protected:
+	virtual void ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const override;
+
+private:
+	/**
+	 * Detect the frames in which the foot is planted from its locations relative to the root
+	 */
+	void DetectPlantedFrames(const FHumanCurveSequenceInfo& Info, const TArray<FVector>& Locations, const FVector& GroundVelocity, TArray<bool>& OutPlanted) const;
+
+	void AddCurve(const FHumanCurveSequenceInfo& Info, const FName& CurveName, TFunctionRef<float(int32)> ValueAtFrame, TArray<FHumanComputedCurve>& OutCurves) const;
+
+};
@@ -4,9 +4,6 @@
 
 #include "LocomotionHumanNameStatics.h"
 
-#include "AnimationBlueprintLibrary.h"
-#include "Animation/AnimSequence.h"
-
 #include UE_INLINE_GENERATED_CPP_BY_NAME(AnimationModifier_CreateHumanLayeringCurves)
 
 UAnimationModifier_CreateHumanLayeringCurves::UAnimationModifier_CreateHumanLayeringCurves()
@@ -49,44 +46,43 @@ UAnimationModifier_CreateHumanLayeringCurves::UAnimationModifier_CreateHumanLaye
 }
 
 
-void UAnimationModifier_CreateHumanLayeringCurves::OnApply_Implementation(UAnimSequence* Sequence)
+void UAnimationModifier_CreateHumanLayeringCurves::ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const
 {
-	Super::OnApply_Implementation(Sequence);
-
-	CreateCurves(Sequence, CurveNames, CurveValue);
+	ComputeLayerCurves(Info, CurveNames, CurveValue, OutCurves);
 
 	if (bAddSlotCurves)
 	{
-		CreateCurves(Sequence, SlotCurveNames, SlotCurveValue);
+		ComputeLayerCurves(Info, SlotCurveNames, SlotCurveValue, OutCurves);
 	}
 }
 
-void UAnimationModifier_CreateHumanLayeringCurves::CreateCurves(UAnimSequence* Sequence, const TArray<FName>& Names, const float Value) const
+void UAnimationModifier_CreateHumanLayeringCurves::ComputeLayerCurves(const FHumanCurveSequenceInfo& Info, const TArray<FName>& Names, const float Value, TArray<FHumanComputedCurve>& OutCurves) const
 {
 	for (const auto& CurveName : Names)
 	{
-		if (UAnimationBlueprintLibrary::DoesCurveExist(Sequence, CurveName, ERawCurveTrackTypes::RCT_Float))
+		if (!bOverrideExistingCurves && Info.DoesCurveExist(CurveName))
 		{
-			if (!bOverrideExistingCurves)
-			{
-				continue;
-			}
-
-			UAnimationBlueprintLibrary::RemoveCurve(Sequence, CurveName);
+			continue;
 		}
 
-		UAnimationBlueprintLibrary::AddCurve(Sequence, CurveName);
+		auto& ComputedCurve{ OutCurves.AddDefaulted_GetRef() };
+		ComputedCurve.Name = CurveName;
 
 		if (bAddKeyOnEachFrame)
 		{
-			for (auto i{ 0 }; i < Sequence->GetNumberOfSampledKeys(); i++)
+			ComputedCurve.Times.Reserve(Info.NumSampledKeys);
+			ComputedCurve.Values.Reserve(Info.NumSampledKeys);
+
+			for (auto i{ 0 }; i < Info.NumSampledKeys; i++)
 			{
-				UAnimationBlueprintLibrary::AddFloatCurveKey(Sequence, CurveName, Sequence->GetTimeAtFrame(i), Value);
+				ComputedCurve.Times.Add(Info.GetTimeAtFrame(i));
+				ComputedCurve.Values.Add(Value);
 			}
 		}
 		else
 		{
-			UAnimationBlueprintLibrary::AddFloatCurveKey(Sequence, CurveName, Sequence->GetTimeAtFrame(0), Value);
+			ComputedCurve.Times.Add(Info.GetTimeAtFrame(0));
+			ComputedCurve.Values.Add(Value);
 		}
 	}
 }
@@ -2,13 +2,13 @@
 
 #pragma once
 
-#include "AnimationModifier.h"
+#include "AnimationModifier_HumanCurvesBase.h"
 
 #include "AnimationModifier_CreateHumanLayeringCurves.generated.h"
 
 
 UCLASS(DisplayName = "AM Create Layering Curves For Human")
-class GLHADDONNODE_API UAnimationModifier_CreateHumanLayeringCurves : public UAnimationModifier
+class GLHADDONNODE_API UAnimationModifier_CreateHumanLayeringCurves : public UAnimationModifier_HumanCurvesBase
 {
 	GENERATED_BODY()
 public:
@@ -37,9 +37,9 @@ protected:
 	TArray<FName> SlotCurveNames;
 
 public:
-	virtual void OnApply_Implementation(UAnimSequence* Sequence) override;
+	virtual void ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const override;
 
 private:
-	void CreateCurves(UAnimSequence* Sequence, const TArray<FName>& Names, float Value) const;
+	void ComputeLayerCurves(const FHumanCurveSequenceInfo& Info, const TArray<FName>& Names, float Value, TArray<FHumanComputedCurve>& OutCurves) const;
 
 };
@@ -0,0 +1,281 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "AnimationModifier_HumanCurvesBase.h"
+
+#include "HumanCurveSummaryUserData.h"
+
+#include "Animation/AnimSequence.h"
+#include "Animation/Skeleton.h"
+#include "Animation/AnimData/IAnimationDataModel.h"
+#include "Animation/AnimData/IAnimationDataController.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(AnimationModifier_HumanCurvesBase)
+
+DEFINE_LOG_CATEGORY_STATIC(LogHumanCurveModifier, Log, All);
+
+#define LOCTEXT_NAMESPACE "AnimationModifier_HumanCurvesBase"
+
+
+FHumanCurveSequenceInfo::FHumanCurveSequenceInfo(const UAnimSequence* Sequence, TConstArrayView<FName> RequiredBoneNames)
+{
+	check(Sequence);
+
+	const auto* DataModel{ Sequence->GetDataModel() };
+
+	NumSampledKeys = Sequence->GetNumberOfSampledKeys();
+	SamplingFrameRate = Sequence->GetSamplingFrameRate();
+	PlayLength = Sequence->GetPlayLength();
+
+	for (const auto& FloatCurve : DataModel->GetFloatCurves())
+	{
+		ExistingCurveNames.Add(FloatCurve.GetName());
+	}
+
+	const auto* Skeleton{ Sequence->GetSkeleton() };
+
+	if (RequiredBoneNames.IsEmpty() || !Skeleton)
+	{
+		return;
+	}
+
+	// Bone tracks are copied here so that the component space transforms can be composed on the worker threads
+
+	const auto& RefSkeleton{ Skeleton->GetReferenceSkeleton() };
+
+	for (const auto& BoneName : RequiredBoneNames)
+	{
+		auto BoneIndex{ RefSkeleton.FindBoneIndex(BoneName) };
+
+		if ((BoneIndex == INDEX_NONE) || RequiredBoneChains.Contains(BoneName))
+		{
+			continue;
+		}
+
+		auto& Chain{ RequiredBoneChains.Add(BoneName) };
+
+		while (BoneIndex != INDEX_NONE)
+		{
+			Chain.Insert(BoneIndex, 0);
+
+			if (!LocalBoneTransforms.Contains(BoneIndex))
+			{
+				auto& Transforms{ LocalBoneTransforms.Add(BoneIndex) };
+				const auto TrackName{ RefSkeleton.GetBoneName(BoneIndex) };
+
+				if (DataModel->IsValidBoneTrackName(TrackName))
+				{
+					DataModel->GetBoneTrackTransforms(TrackName, Transforms);
+				}
+
+				if (Transforms.IsEmpty())
+				{
+					Transforms.Add(RefSkeleton.GetRefBonePose()[BoneIndex]);
+				}
+			}
+
+			BoneIndex = RefSkeleton.GetParentIndex(BoneIndex);
+		}
+	}
+}
+
+FTransform FHumanCurveSequenceInfo::GetComponentSpaceBoneTransform(const FName& BoneName, int32 Frame) const
+{
+	const auto* Chain{ RequiredBoneChains.Find(BoneName) };
+
+	if (!Chain)
+	{
+		return FTransform::Identity;
+	}
+
+	auto Transform{ FTransform::Identity };
+
+	for (const auto& BoneIndex : *Chain)
+	{
+		const auto& Transforms{ LocalBoneTransforms.FindChecked(BoneIndex) };
+
+		Transform = Transforms[FMath::Min(Frame, Transforms.Num() - 1)] * Transform;
+	}
+
+	return Transform;
+}
+
+FTransform FHumanCurveSequenceInfo::GetRootBoneTransform(int32 Frame) const
+{
+	const auto* Transforms{ LocalBoneTransforms.Find(0) };
+
+	return Transforms ? (*Transforms)[FMath::Min(Frame, Transforms->Num() - 1)] : FTransform::Identity;
+}
+
+
+void UAnimationModifier_HumanCurvesBase::OnApply_Implementation(UAnimSequence* Sequence)
+{
+	Super::OnApply_Implementation(Sequence);
+
+	if (!Sequence)
+	{
+		return;
+	}
+
+	TArray<FName> RequiredBoneNames;
+	GetRequiredBones(RequiredBoneNames);
+
+	TArray<FHumanComputedCurve> ComputedCurves;
+	const auto NumRemovedKeys{ Compute(FHumanCurveSequenceInfo(Sequence, RequiredBoneNames), ComputedCurves) };
+
+	ApplyCurves(Sequence, ComputedCurves);
+
+	if (NumRemovedKeys > 0)
+	{
+		UE_LOG(LogHumanCurveModifier, Log, TEXT("%s: Removed %d redundant keys (%d bytes)"),
+			*Sequence->GetName(), NumRemovedKeys, NumRemovedKeys * static_cast<int32>(sizeof(FRichCurveKey)));
+	}
+}
+
+int32 UAnimationModifier_HumanCurvesBase::Compute(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const
+{
+	const auto FirstCurveIndex{ OutCurves.Num() };
+
+	ComputeCurves(Info, OutCurves);
+
+	auto NumRemovedKeys{ 0 };
+
+	if (bReduceKeys)
+	{
+		for (auto i{ FirstCurveIndex }; i < OutCurves.Num(); i++)
+		{
+			NumRemovedKeys += ReduceKeys(OutCurves[i], KeyReductionTolerance);
+		}
+	}
+
+	return NumRemovedKeys;
+}
+
+int32 UAnimationModifier_HumanCurvesBase::ReduceKeys(FHumanComputedCurve& Curve, float Tolerance)
+{
+	check(Curve.Times.Num() == Curve.Values.Num());
+
+	const auto NumKeys{ Curve.Times.Num() };
+
+	if (NumKeys <= 1)
+	{
+		return 0;
+	}
+
+	// Constant curve
+
+	auto MinValue{ Curve.Values[0] };
+	auto MaxValue{ Curve.Values[0] };
+
+	for (const auto& Value : Curve.Values)
+	{
+		MinValue = FMath::Min(MinValue, Value);
+		MaxValue = FMath::Max(MaxValue, Value);
+	}
+
+	if ((MaxValue - MinValue) <= Tolerance)
+	{
+		Curve.Times.SetNum(1);
+		Curve.Values.SetNum(1);
+		return NumKeys - 1;
+	}
+
+	// Extend the segment from the last kept key as long as every key inside it stays on the line within Tolerance
+
+	const auto IsSegmentWithinTolerance
+	{
+		[&Curve, Tolerance](int32 Start, int32 End)
+		{
+			const auto StartTime{ Curve.Times[Start] };
+			const auto Duration{ Curve.Times[End] - StartTime };
+
+			for (auto i{ Start + 1 }; i < End; i++)
+			{
+				const auto Alpha{ (Duration > UE_SMALL_NUMBER) ? (Curve.Times[i] - StartTime) / Duration : 0.0f };
+
+				if (FMath::Abs(FMath::Lerp(Curve.Values[Start], Curve.Values[End], Alpha) - Curve.Values[i]) > Tolerance)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+	};
+
+	auto NumKeptKeys{ 1 };
+	auto AnchorIndex{ 0 };
+
+	for (auto i{ 2 }; i < NumKeys; i++)
+	{
+		if (!IsSegmentWithinTolerance(AnchorIndex, i))
+		{
+			AnchorIndex = i - 1;
+
+			Curve.Times[NumKeptKeys] = Curve.Times[AnchorIndex];
+			Curve.Values[NumKeptKeys] = Curve.Values[AnchorIndex];
+			NumKeptKeys++;
+		}
+	}
+
+	Curve.Times[NumKeptKeys] = Curve.Times[NumKeys - 1];
+	Curve.Values[NumKeptKeys] = Curve.Values[NumKeys - 1];
+	NumKeptKeys++;
+
+	Curve.Times.SetNum(NumKeptKeys);
+	Curve.Values.SetNum(NumKeptKeys);
+
+	return NumKeys - NumKeptKeys;
+}
+
+void UAnimationModifier_HumanCurvesBase::ApplyCurves(UAnimSequence* Sequence, const TArray<FHumanComputedCurve>& Curves)
+{
+	check(IsInGameThread());
+
+	if (!Curves.IsEmpty())
+	{
+		// All curves are written in a single bracket so that the sequence is notified and rebuilt only once.
+		// Keys are set as a whole instead of one by one, which would go through the controller for each key.
+
+		const auto* DataModel{ Sequence->GetDataModel() };
+		auto& Controller{ Sequence->GetController() };
+
+		IAnimationDataController::FScopedBracket ScopedBracket(Controller, LOCTEXT("ApplyHumanCurves", "Apply Human Curves"));
+
+		TArray<FRichCurveKey> Keys;
+
+		for (const auto& Curve : Curves)
+		{
+			const FAnimationCurveIdentifier CurveId{ Curve.Name, ERawCurveTrackTypes::RCT_Float };
+
+			if (DataModel->FindFloatCurve(CurveId))
+			{
+				Controller.RemoveCurve(CurveId);
+			}
+
+			Controller.AddCurve(CurveId);
+
+			Keys.Reset(Curve.Times.Num());
+
+			for (auto i{ 0 }; i < Curve.Times.Num(); i++)
+			{
+				Keys.Emplace(Curve.Times[i], Curve.Values[i]);
+			}
+
+			Controller.SetCurveKeys(CurveId, Keys);
+		}
+	}
+
+	// Summary of the curves read by UHumanAnimInstance to elide the reads of the constant curves
+
+	auto* CurveSummary{ Sequence->GetAssetUserData<UHumanCurveSummaryUserData>() };
+
+	if (!CurveSummary)
+	{
+		CurveSummary = NewObject<UHumanCurveSummaryUserData>(Sequence, NAME_None, RF_Transactional);
+		Sequence->AddAssetUserData(CurveSummary);
+	}
+
+	CurveSummary->Refresh(Sequence);
+}
+
+#undef LOCTEXT_NAMESPACE
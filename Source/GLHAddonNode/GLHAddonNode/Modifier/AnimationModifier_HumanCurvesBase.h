@@ -0,0 +1,161 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "AnimationModifier.h"
+
+#include "Misc/FrameRate.h"
+
+#include "AnimationModifier_HumanCurvesBase.generated.h"
+
+
+/**
+ * Data of the sequence read on the game thread that is needed to compute the curves
+ */
+struct GLHADDONNODE_API FHumanCurveSequenceInfo
+{
+public:
+	FHumanCurveSequenceInfo() = default;
+	explicit FHumanCurveSequenceInfo(const UAnimSequence* Sequence, TConstArrayView<FName> RequiredBoneNames = TConstArrayView<FName>());
+
+public:
+	int32 NumSampledKeys{ 0 };
+
+	FFrameRate SamplingFrameRate;
+
+	double PlayLength{ 0.0 };
+
+	TSet<FName> ExistingCurveNames;
+
+	//
+	// Local transforms of each frame of the required bones and their ancestors indexed by skeleton bone index.
+	// Bones without a track hold only the reference pose.
+	//
+	TMap<int32, TArray<FTransform>> LocalBoneTransforms;
+
+	//
+	// Skeleton bone indices from the root to each required bone
+	//
+	TMap<FName, TArray<int32>> RequiredBoneChains;
+
+public:
+	/**
+	 * Same as UAnimSequenceBase::GetTimeAtFrame()
+	 */
+	float GetTimeAtFrame(int32 Frame) const
+	{
+		return FMath::Clamp(static_cast<float>(SamplingFrameRate.AsSeconds(Frame)), 0.0f, static_cast<float>(PlayLength));
+	}
+
+	bool DoesCurveExist(const FName& CurveName) const
+	{
+		return ExistingCurveNames.Contains(CurveName);
+	}
+
+	bool HasBone(const FName& BoneName) const
+	{
+		return RequiredBoneChains.Contains(BoneName);
+	}
+
+	/**
+	 * Returns the component space transform of the required bone at the frame
+	 */
+	FTransform GetComponentSpaceBoneTransform(const FName& BoneName, int32 Frame) const;
+
+	/**
+	 * Returns the local transform of the root bone at the frame, which is the same in component space
+	 */
+	FTransform GetRootBoneTransform(int32 Frame) const;
+
+};
+
+
+/**
+ * Float curve computed by a modifier, which is written to the sequence on the game thread
+ */
+struct GLHADDONNODE_API FHumanComputedCurve
+{
+public:
+	FName Name;
+
+	TArray<float> Times;
+
+	TArray<float> Values;
+
+};
+
+
+/**
+ * Base class of the modifiers that create the curves of the human character
+ * 
+ * Tips:
+ *	Curves are computed from FHumanCurveSequenceInfo without touching the sequence, so that they can be computed on worker threads.
+ *	Only ApplyCurves() modifies the sequence and it must be called on the game thread.
+ */
+UCLASS(Abstract)
+class GLHADDONNODE_API UAnimationModifier_HumanCurvesBase : public UAnimationModifier
+{
+	GENERATED_BODY()
+public:
+	UAnimationModifier_HumanCurvesBase() {}
+
+protected:
+	//
+	// Whether to remove the keys that can be linearly interpolated from their neighbors after the curves are computed
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Key Reduction")
+	bool bReduceKeys{ true };
+
+	//
+	// Maximum error of the value allowed when removing the keys
+	//
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Settings|Key Reduction", Meta = (ClampMin = 0, EditCondition = "bReduceKeys"))
+	float KeyReductionTolerance{ 0.001f };
+
+public:
+	virtual void OnApply_Implementation(UAnimSequence* Sequence) override;
+
+	/**
+	 * Compute the curves to be added to the sequence and reduce their keys
+	 * 
+	 * Tips:
+	 *	Must be thread safe since it is called on worker threads by the batch commandlet.
+	 * 
+	 * @return Number of keys removed by the reduction
+	 */
+	int32 Compute(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const;
+
+	/**
+	 * Add the names of the bones whose transforms must be read into FHumanCurveSequenceInfo
+	 */
+	virtual void GetRequiredBones(TArray<FName>& OutBoneNames) const {}
+
+	/**
+	 * Returns whether the batch commandlet applies this modifier when no modifiers are specified
+	 */
+	virtual bool IsAppliedByDefault() const { return true; }
+
+protected:
+	/**
+	 * Compute the curves to be added to the sequence
+	 */
+	virtual void ComputeCurves(const FHumanCurveSequenceInfo& Info, TArray<FHumanComputedCurve>& OutCurves) const {}
+
+public:
+	/**
+	 * Collapse the constant runs and linear segments of the curve within Tolerance
+	 * 
+	 * Tips:
+	 *	Keys are linearly interpolated, so a key is removed when the line between the kept keys around it is within Tolerance of every removed key.
+	 *	A curve whose keys all have the same value is reduced to a single key, which is evaluated as a constant.
+	 * 
+	 * @return Number of keys removed
+	 */
+	static int32 ReduceKeys(FHumanComputedCurve& Curve, float Tolerance);
+
+	/**
+	 * Write the computed curves to the sequence, replacing the existing curves with the same names
+	 */
+	static void ApplyCurves(UAnimSequence* Sequence, const TArray<FHumanComputedCurve>& Curves);
+
+};
@@ -0,0 +1,88 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "Utility/HumanLocomotionSpeedExtractionLibrary.h"
+
+#include "Modifier/AnimationModifier_HumanCurvesBase.h"
+
+#include "LocomotionHumanNameStatics.h"
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace HumanLocomotionSpeedExtractionTests
+{
+	static constexpr auto Speed{ 300.0f };
+	static constexpr auto NumFrames{ 31 };
+	static constexpr auto FootLiftHeight{ 10.0f };
+
+	/**
+	 * Build a one second clip at 30 fps in which the left foot stays planted on the ground and the right foot stays lifted
+	 *
+	 * Tips:
+	 *	Bone 0 is the root, and the feet are its children.
+	 */
+	static FHumanCurveSequenceInfo MakeCycleInfo(bool bRootMotion)
+	{
+		FHumanCurveSequenceInfo Info;
+		Info.NumSampledKeys = NumFrames;
+		Info.SamplingFrameRate = FFrameRate(30, 1);
+		Info.PlayLength = 1.0;
+
+		Info.RequiredBoneChains.Add(ULocomotionHumanNameStatics::FootLeftBoneName(), { 0, 1 });
+		Info.RequiredBoneChains.Add(ULocomotionHumanNameStatics::FootRightBoneName(), { 0, 2 });
+
+		auto& RootTransforms{ Info.LocalBoneTransforms.Add(0) };
+		auto& LeftTransforms{ Info.LocalBoneTransforms.Add(1) };
+		auto& RightTransforms{ Info.LocalBoneTransforms.Add(2) };
+
+		for (auto Frame{ 0 }; Frame < NumFrames; Frame++)
+		{
+			const auto Distance{ Speed * Info.GetTimeAtFrame(Frame) };
+
+			// With root motion the root travels and the planted foot stays in place.
+			// Without it the root stays in place and the planted foot slides backward.
+
+			const FVector RootLocation{ bRootMotion ? Distance : 0.0f, 0.0f, 0.0f };
+			const FVector LeftLocation{ bRootMotion ? 0.0f : -Distance, 10.0f, 0.0f };
+
+			RootTransforms.Add(FTransform(RootLocation));
+			LeftTransforms.Add(FTransform(LeftLocation - RootLocation));
+			RightTransforms.Add(FTransform(FVector(0.0f, -10.0f, FootLiftHeight)));
+		}
+
+		return Info;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHumanLocomotionSpeedExtractionRootMotionTest, "GLHAddon.LocomotionSpeedExtraction.RootMotion",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHumanLocomotionSpeedExtractionRootMotionTest::RunTest(const FString& Parameters)
+{
+	using namespace HumanLocomotionSpeedExtractionTests;
+
+	const auto Info{ MakeCycleInfo(true) };
+
+	TestEqual(TEXT("Root motion clip measured from the feet"), UHumanLocomotionSpeedExtractionLibrary::MeasureLocomotionSpeedFromInfo(Info, true), Speed, 1.0f);
+	TestEqual(TEXT("Root motion clip measured from the root"), UHumanLocomotionSpeedExtractionLibrary::MeasureLocomotionSpeedFromInfo(Info, false), Speed, 1.0f);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FHumanLocomotionSpeedExtractionInPlaceTest, "GLHAddon.LocomotionSpeedExtraction.InPlace",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FHumanLocomotionSpeedExtractionInPlaceTest::RunTest(const FString& Parameters)
+{
+	using namespace HumanLocomotionSpeedExtractionTests;
+
+	const auto Info{ MakeCycleInfo(false) };
+
+	TestEqual(TEXT("In-place clip measured from the feet"), UHumanLocomotionSpeedExtractionLibrary::MeasureLocomotionSpeedFromInfo(Info, true), Speed, 1.0f);
+	TestEqual(TEXT("In-place clip measured from the root"), UHumanLocomotionSpeedExtractionLibrary::MeasureLocomotionSpeedFromInfo(Info, false), 0.0f, 1.0f);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,133 @@
+﻿// Copyright (C) 2024 owoDra
+
+#include "HumanLocomotionSpeedExtractionLibrary.h"
+
+#include "Modifier/AnimationModifier_HumanCurvesBase.h"
+#include "Modifier/AnimationModifier_CreateHumanFootCurves.h"
+
+#include "HumanLocomotionSpeedSettings.h"
+#include "LocomotionHumanNameStatics.h"
+
+#include "Animation/AnimSequence.h"
+
+#include UE_INLINE_GENERATED_CPP_BY_NAME(HumanLocomotionSpeedExtractionLibrary)
+
+DEFINE_LOG_CATEGORY_STATIC(LogHumanLocomotionSpeedExtraction, Log, All);
+
+
+float UHumanLocomotionSpeedExtractionLibrary::MeasureLocomotionSpeed(const UAnimSequence* Sequence, bool bFromFeet)
+{
+	if (!Sequence || (Sequence->GetPlayLength() <= UE_SMALL_NUMBER))
+	{
+		return 0.0f;
+	}
+
+	const FName RequiredBoneNames[]{ ULocomotionHumanNameStatics::FootLeftBoneName(), ULocomotionHumanNameStatics::FootRightBoneName() };
+
+	return MeasureLocomotionSpeedFromInfo(FHumanCurveSequenceInfo(Sequence, RequiredBoneNames), bFromFeet);
+}
+
+float UHumanLocomotionSpeedExtractionLibrary::MeasureLocomotionSpeedFromInfo(const FHumanCurveSequenceInfo& Info, bool bFromFeet)
+{
+	static constexpr auto RootMotionSpeedThreshold{ 1.0f };
+
+	if ((Info.NumSampledKeys < 2) || (Info.PlayLength <= UE_SMALL_NUMBER))
+	{
+		return 0.0f;
+	}
+
+	// Average velocity of the root
+
+	const auto RootStart{ Info.GetRootBoneTransform(0) };
+	const auto RootEnd{ Info.GetRootBoneTransform(Info.NumSampledKeys - 1) };
+
+	const auto RootSpeed{ RootStart.InverseTransformVector(RootEnd.GetLocation() - RootStart.GetLocation()).Size2D() / Info.PlayLength };
+
+	if (RootSpeed > RootMotionSpeedThreshold)
+	{
+		return static_cast<float>(RootSpeed);
+	}
+
+	// The feet are sampled relative to the root, so the ground moves backward at the speed of the sequence whether or not it has root motion.
+	// Only in-place sequences need it, since the root speed is exact for the others.
+
+	const auto& FootLeftBoneName{ ULocomotionHumanNameStatics::FootLeftBoneName() };
+	const auto& FootRightBoneName{ ULocomotionHumanNameStatics::FootRightBoneName() };
+
+	TArray<FVector> LeftLocations;
+	TArray<FVector> RightLocations;
+
+	if (bFromFeet && UAnimationModifier_CreateHumanFootCurves::SampleFeetLocations(Info, FootLeftBoneName, FootRightBoneName, LeftLocations, RightLocations))
+	{
+		return static_cast<float>(UAnimationModifier_CreateHumanFootCurves::EstimateGroundVelocity(Info, LeftLocations, RightLocations).Size2D());
+	}
+
+	return static_cast<float>(RootSpeed);
+}
+
+bool UHumanLocomotionSpeedExtractionLibrary::ExtractLocomotionSpeedSettings(UHumanLocomotionSpeedSettings* Settings)
+{
+	if (!Settings)
+	{
+		return false;
+	}
+
+	auto bMeasured{ false };
+
+	Settings->Modify();
+
+	const auto Measure
+	{
+		[&](const TSoftObjectPtr<UAnimSequence>& SoftSequence, float& OutSpeed)
+		{
+			const auto* Sequence{ SoftSequence.LoadSynchronous() };
+
+			if (!Sequence)
+			{
+				return;
+			}
+
+			const auto Speed{ MeasureLocomotionSpeed(Sequence, Settings->bMeasureFromFeet) };
+
+			if (Speed > UE_KINDA_SMALL_NUMBER)
+			{
+				UE_LOG(LogHumanLocomotionSpeedExtraction, Log, TEXT("%s: %.2f cm/s"), *Sequence->GetName(), Speed);
+
+				OutSpeed = Speed;
+				bMeasured = true;
+			}
+			else
+			{
+				UE_LOG(LogHumanLocomotionSpeedExtraction, Warning, TEXT("%s: Failed to measure the speed"), *Sequence->GetName());
+			}
+		}
+	};
+
+	Measure(Settings->WalkSequence, Settings->AnimatedWalkSpeed);
+	Measure(Settings->RunSequence, Settings->AnimatedRunSpeed);
+	Measure(Settings->SprintSequence, Settings->AnimatedSprintSpeed);
+	Measure(Settings->CrouchSequence, Settings->AnimatedCrouchSpeed);
+
+	GenerateStrideBlendAmountCurve(*Settings->StrideBlendAmountWalkCurve.GetRichCurve(), Settings->AnimatedWalkSpeed, Settings->MinStrideBlendAmount);
+	GenerateStrideBlendAmountCurve(*Settings->StrideBlendAmountRunCurve.GetRichCurve(), Settings->AnimatedRunSpeed, Settings->MinStrideBlendAmount);
+
+	Settings->MarkPackageDirty();
+
+	return bMeasured;
+}
+
+void UHumanLocomotionSpeedExtractionLibrary::GenerateStrideBlendAmountCurve(FRichCurve& Curve, float AnimatedSpeed, float MinStrideBlendAmount)
+{
+	// The stride shortens linearly below the animated speed so that the play rate does not drop too low, and is constant above it
+
+	Curve.Reset();
+
+	const auto StartKey{ Curve.AddKey(0.0f, MinStrideBlendAmount) };
+	const auto EndKey{ Curve.AddKey(FMath::Max(AnimatedSpeed, UE_KINDA_SMALL_NUMBER), 1.0f) };
+
+	Curve.SetKeyInterpMode(StartKey, RCIM_Linear);
+	Curve.SetKeyInterpMode(EndKey, RCIM_Linear);
+
+	Curve.PreInfinityExtrap = RCCE_Constant;
+	Curve.PostInfinityExtrap = RCCE_Constant;
+}
@@ -0,0 +1,51 @@
+﻿// Copyright (C) 2024 owoDra
+
+#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+
+#include "HumanLocomotionSpeedExtractionLibrary.generated.h"
+
+class UAnimSequence;
+class UHumanLocomotionSpeedSettings;
+struct FHumanCurveSequenceInfo;
+
+
+/**
+ * Editor functions that measure the locomotion speeds of the cycle sequences and write them to UHumanLocomotionSpeedSettings
+ */
+UCLASS()
+class GLHADDONNODE_API UHumanLocomotionSpeedExtractionLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+public:
+	UHumanLocomotionSpeedExtractionLibrary() {}
+
+public:
+	/**
+	 * Returns the horizontal speed at which the sequence moves over the ground
+	 * 
+	 * Tips:
+	 *	The speed is measured from the root motion.
+	 *	When bFromFeet is true, sequences without root motion are measured from their planted feet instead.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Human Locomotion|Editor")
+	static float MeasureLocomotionSpeed(const UAnimSequence* Sequence, bool bFromFeet = true);
+
+	/**
+	 * Same as MeasureLocomotionSpeed() for the sampled feet of the sequence
+	 */
+	static float MeasureLocomotionSpeedFromInfo(const FHumanCurveSequenceInfo& Info, bool bFromFeet = true);
+
+	/**
+	 * Measure the source sequences of the settings and generate its animated speeds and stride blend curves
+	 * 
+	 * @return False if no source sequence could be measured
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Human Locomotion|Editor")
+	static bool ExtractLocomotionSpeedSettings(UHumanLocomotionSpeedSettings* Settings);
+
+private:
+	static void GenerateStrideBlendAmountCurve(FRichCurve& Curve, float AnimatedSpeed, float MinStrideBlendAmount);
+
+};